@@ -0,0 +1,240 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "answer.h"
+
+#include "dialogs.h"
+#include "ksshaskpass_debug.h"
+#include "promptgate.h"
+#include "resulttable.h"
+#include "sessioncache.h"
+#include "settings.h"
+#include "totp.h"
+#include "walletentry.h"
+
+#include <KLocalizedString>
+
+// Seconds an answer that must not go to the wallet is remembered for, 0 if not at all.
+static int sessionTimeout(const ParsedPrompt &prompt)
+{
+    return prompt.sessionOnly ? settings(QStringLiteral("Sudo")).readEntry("CacheTimeout", 300) : 0;
+}
+
+// The key file a passphrase is checked against before it is handed out, if that is enabled.
+static QString verifyKeyFile(const ParsedPrompt &prompt, const WalletEntry &entry)
+{
+    return (prompt.type == TypePassword && settings().readEntry("VerifyKeyPassphrases", false)) ? entry.keyFile() : QString();
+}
+
+// Answers that must not go to the wallet, like sudo passwords, are remembered for a few minutes in the keyring of
+// the login session they were given in. sudo asks again from the same process if the password was wrong, so the
+// caller an answer was given to is remembered too, and the answer is dropped when that caller asks again.
+static QString lookupSessionAnswer(const QString &identifier, qint64 caller, int timeout)
+{
+    const QByteArray answer = SessionCache::lookup(identifier, SessionCache::LoginSessionKeyring);
+    if (answer.isNull()) {
+        return QString();
+    }
+    const QString callerName = identifier + QLatin1String(":caller");
+    const QByteArray callerId = QByteArray::number(caller);
+    if (SessionCache::lookup(callerName, SessionCache::LoginSessionKeyring) == callerId) {
+        SessionCache::remove(identifier, SessionCache::LoginSessionKeyring);
+        SessionCache::remove(callerName, SessionCache::LoginSessionKeyring);
+        return QString();
+    }
+    SessionCache::store(callerName, callerId, timeout, SessionCache::LoginSessionKeyring);
+    return QString::fromUtf8(answer);
+}
+
+static void storeSessionAnswer(const QString &identifier, qint64 caller, const QString &answer, int timeout)
+{
+    SessionCache::store(identifier, answer.toUtf8(), timeout, SessionCache::LoginSessionKeyring);
+    SessionCache::store(identifier + QLatin1String(":caller"), QByteArray::number(caller), timeout, SessionCache::LoginSessionKeyring);
+}
+
+// The key of the table of recent answers an answer to the prompt may be kept under, or a null string if it must not
+// be kept there. One-time passwords are used up, answers for the session cache stay in there, answers to
+// prompts no rule knows are checked against their caller first, and a password change is no host password.
+static QString recentAnswerKey(const ParsedPrompt &prompt)
+{
+    if (prompt.identifier.isEmpty() || prompt.type == TypeOtp || prompt.sessionOnly || prompt.guessedIdentifier
+        || prompt.passwordChange != PasswordChangeNone) {
+        return QString();
+    }
+    return QString::number(prompt.type) + QLatin1Char(':') + prompt.identifier;
+}
+
+// Confirmations are kept as "<caller>\n<answer>", and never handed to the caller they were given to. ssh-agent asks
+// for every use of a key added with ssh-add -c, and ssh for every use of a shared connection, each of which has to
+// be confirmed on its own.
+static void keepRecentAnswer(const ParsedPrompt &prompt, qint64 caller, const QString &answer)
+{
+    const QString key = recentAnswerKey(prompt);
+    if (!key.isNull()) {
+        ResultTable::store(key, prompt.type == TypeConfirm ? QString::number(caller) + QLatin1Char('\n') + answer : answer);
+    }
+}
+
+QString lookupRecentAnswer(const ParsedPrompt &prompt, qint64 caller)
+{
+    const QString key = recentAnswerKey(prompt);
+    if (key.isNull()) {
+        return QString();
+    }
+    if (prompt.retry) {
+        ResultTable::remove(key);
+        return QString();
+    }
+    const QString answer = ResultTable::lookup(key);
+    if (prompt.type != TypeConfirm || answer.isNull()) {
+        return answer;
+    }
+    const int newline = answer.indexOf(QLatin1Char('\n'));
+    if (newline < 0 || QStringView(answer).left(newline) == QString::number(caller)) {
+        return QString();
+    }
+    return answer.mid(newline + 1);
+}
+
+// The new password chosen in the dialog of an expired password change is handed to the prompts that follow it
+// through the session cache, for this long at most.
+static const int passwordChangeTimeout = 60;
+
+static QString passwordChangeName(const QString &identifier, qint64 caller)
+{
+    return QStringLiteral("passwordchange:%1:").arg(caller) + identifier;
+}
+
+// Whether caller is the one that was last answered for identifier in the past minute, and remembers it if not.
+static bool isRepeatedCaller(const QString &identifier, qint64 caller)
+{
+    const QString callerName = identifier + QLatin1String(":caller");
+    const QByteArray callerId = QByteArray::number(caller);
+    if (SessionCache::lookup(callerName) == callerId) {
+        SessionCache::remove(callerName);
+        return true;
+    }
+    SessionCache::store(callerName, callerId, 60);
+    return false;
+}
+
+// Which stored item was last answered to caller for identifier is remembered in the session cache, by its digest,
+// for this long. A retry only rejects the stored item if it is the one the caller got, not one the user typed.
+static const int servedTimeout = 60;
+
+static QString servedName(const QString &identifier, qint64 caller)
+{
+    return QStringLiteral("served:%1:").arg(caller) + identifier;
+}
+
+QString lookupAnswer(const ParsedPrompt &prompt, WalletEntry &entry, qint64 caller)
+{
+    QString item;
+    if (!prompt.ignoreWallet) {
+        item = entry.read(!verifyKeyFile(prompt, entry).isNull());
+    }
+
+    // For one-time passwords the wallet holds the seed, the code is computed from it
+    if (prompt.type == TypeOtp && !item.isEmpty()) {
+        item = totpCode(item);
+        if (item.isNull()) {
+            qCWarning(LOG_KSSHASKPASS) << "Unable to compute a one-time password from the seed stored for" << prompt.identifier;
+        }
+    }
+    // A program we don't know can't say that an answer was wrong. If it asks again right away, the user is asked
+    // too, and can keep a different answer.
+    if (prompt.guessedIdentifier && !item.isEmpty() && isRepeatedCaller(prompt.identifier, caller)) {
+        item.clear();
+    }
+    if (!item.isEmpty()) {
+        keepRecentAnswer(prompt, caller, item);
+        if (prompt.type != TypeOtp) {
+            SessionCache::store(servedName(prompt.identifier, caller), entry.digest(item).toLatin1(), servedTimeout);
+        }
+    }
+
+    if (prompt.retry) {
+        const QString name = servedName(prompt.identifier, caller);
+        entry.reject(QString::fromLatin1(SessionCache::lookup(name)));
+        SessionCache::remove(name);
+    }
+
+    const int timeout = sessionTimeout(prompt);
+    if (timeout > 0) {
+        item = lookupSessionAnswer(prompt.identifier, caller, timeout);
+    }
+
+    if (prompt.passwordChange == PasswordChangeNew || prompt.passwordChange == PasswordChangeRetype) {
+        const QString name = passwordChangeName(prompt.identifier, caller);
+        item = QString::fromUtf8(SessionCache::lookup(name));
+        if (prompt.passwordChange == PasswordChangeRetype) {
+            SessionCache::remove(name);
+        }
+    }
+    return item;
+}
+
+bool askUser(const ParsedPrompt &prompt, WalletEntry &entry, qint64 caller, QString &answer, const QString &title)
+{
+    // OpenSSH asks for the old password first, then for the new one twice. All three are asked for right away.
+    if (prompt.passwordChange == PasswordChangeOld) {
+        QString newPassword;
+        if (!askPasswordChange(i18n("The password for %1 has to be changed.", prompt.identifier), answer, newPassword)) {
+            return false;
+        }
+        SessionCache::store(passwordChangeName(prompt.identifier, caller), newPassword.toUtf8(), passwordChangeTimeout);
+        return true;
+    }
+
+    switch (prompt.type) {
+    case TypeConfirm:
+        if (!askConfirmation(prompt.text, title)) {
+            // dialog has been canceled
+            return false;
+        }
+        answer = QStringLiteral("yes\n");
+        keepRecentAnswer(prompt, caller, answer);
+        break;
+    case TypeClearText:
+    case TypePassword:
+    case TypeOtp: {
+        PasswordQuestion question;
+        question.prompt = prompt.text;
+        question.title = title;
+        question.keyFile = verifyKeyFile(prompt, entry);
+        question.clearText = prompt.type != TypePassword;
+        // A one-time password is useless once used
+        question.offerKeep = entry.isValid() && prompt.type != TypeOtp;
+        bool keep = false;
+        if (!askPassword(question, answer, keep)) {
+            // dialog has been canceled
+            return false;
+        }
+        // If "Enable Keep" is enabled, store the password.
+        if (keep) {
+            entry.write(answer);
+            keepRecentAnswer(prompt, caller, answer);
+        }
+        const int timeout = sessionTimeout(prompt);
+        if (timeout > 0) {
+            storeSessionAnswer(prompt.identifier, caller, answer, timeout);
+        }
+        break;
+    }
+    }
+    return true;
+}
+
+bool askAnswer(const ParsedPrompt &prompt, WalletEntry &entry, qint64 caller, QString &answer, const QString &title)
+{
+    PromptGate gate(prompt, caller);
+    bool answered = false;
+    if (!gate.waitForTurn(answered, answer)) {
+        return answered;
+    }
+    answered = askUser(prompt, entry, caller, answer, title);
+    gate.decide(answered, answer);
+    return answered;
+}
@@ -0,0 +1,29 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "prompt.h"
+
+#include <QString>
+
+class WalletEntry;
+
+// Returns an answer given to the same question a moment ago, from the table of recent answers if that is enabled,
+// or an empty string. A retry drops the answer it says was wrong. caller is the process id of the program asking,
+// which never gets a confirmation it was given before.
+QString lookupRecentAnswer(const ParsedPrompt &prompt, qint64 caller);
+
+// Looks the answer up in the wallet entry and, for answers that must not be stored, in the session cache, and
+// rejects a stored answer the prompt says was wrong. caller is the process id of the program asking. Returns an
+// empty string if nothing is known.
+QString lookupAnswer(const ParsedPrompt &prompt, WalletEntry &entry, qint64 caller);
+
+// Asks the user, once a dialog may be shown, and keeps the answer where the prompt and the user allow it. A prompt
+// that was just decided elsewhere gets that decision instead. Returns false if the user canceled.
+bool askAnswer(const ParsedPrompt &prompt, WalletEntry &entry, qint64 caller, QString &answer, const QString &title = QString());
+
+// Like askAnswer, but asks right away. For callers that wait for their turn with a PromptGate of their own.
+bool askUser(const ParsedPrompt &prompt, WalletEntry &entry, qint64 caller, QString &answer, const QString &title = QString());
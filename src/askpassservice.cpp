@@ -0,0 +1,198 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "askpassservice.h"
+
+#include "answer.h"
+#include "config-ksshaskpass.h"
+#include "ksshaskpass_debug.h"
+#include "promptgate.h"
+#include "secretstore.h"
+#include "walletentry.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusContext>
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QQueue>
+#include <QTimer>
+#include <QVariantMap>
+#if HAVE_GUI
+#include <QGuiApplication>
+#endif
+
+#include <map>
+#include <memory>
+
+namespace
+{
+const char serviceName[] = "org.kde.ksshaskpass";
+const char objectPath[] = "/AskPass";
+const char cancelledError[] = "org.kde.ksshaskpass.Error.Cancelled";
+
+class AskPassService : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.ksshaskpass.AskPass")
+
+public:
+    AskPassService() = default;
+
+public Q_SLOTS:
+    // Answers prompt like "ksshaskpass <prompt>" would, confirmations with "yes". hints may hold a "title" for
+    // the dialog. Fails with org.kde.ksshaskpass.Error.Cancelled if the user cancels.
+    Q_SCRIPTABLE QString AskPass(const QString &prompt, const QVariantMap &hints)
+    {
+        Request request;
+        request.caller = connection().interface()->servicePid(message().service()).value();
+        request.prompt = ParsedPrompt(prompt, request.caller);
+        request.title = hints.value(QStringLiteral("title")).toString();
+        request.message = message();
+
+        // What is known already is answered right away, even while a dialog is open
+        QString answer = lookupRecentAnswer(request.prompt, request.caller);
+        if (answer.isEmpty()) {
+            const std::shared_ptr<SecretStore> store = wallet(request.prompt);
+            WalletEntry entry(store.get(), request.prompt.identifier, request.prompt.type == TypePassword);
+            answer = lookupAnswer(request.prompt, entry, request.caller);
+        }
+        if (!answer.isEmpty()) {
+            return replyText(answer);
+        }
+
+        setDelayedReply(true);
+        m_queue.enqueue(request);
+        QMetaObject::invokeMethod(this, &AskPassService::askNext, Qt::QueuedConnection);
+        return QString();
+    }
+
+private:
+    struct Request {
+        ParsedPrompt prompt;
+        QString title;
+        qint64 caller = 0;
+        QDBusMessage message;
+    };
+
+    // Confirmations come as "yes\n", meant for stdout
+    static QString replyText(QString answer)
+    {
+        if (answer.endsWith(QLatin1Char('\n'))) {
+            answer.chop(1);
+        }
+        return answer;
+    }
+
+    // Dialogs run their own event loop, so calls keep coming in while one is open. They wait their turn here.
+    // Every request in the queue was looked up by AskPass() already, and is not looked up again: lookupAnswer()
+    // keeps track of who asked, which would take a second lookup for the same caller asking again. What an
+    // earlier dialog decided meanwhile comes through the gate.
+    void askNext()
+    {
+        if (m_asking || m_queue.isEmpty()) {
+            return;
+        }
+        m_asking = true;
+        const Request &request = m_queue.head();
+        m_gate = std::make_unique<PromptGate>(request.prompt, request.caller);
+        takeTurn();
+    }
+
+    // While a dialog of another ksshaskpass process holds the slot, this looks again from a timer, so other calls
+    // are still answered from the wallet meanwhile.
+    void takeTurn()
+    {
+        // A copy, calls coming in while the dialog is open grow the queue
+        const Request request = m_queue.head();
+        bool answered = false;
+        QString answer;
+        switch (m_gate->tryTurn(answered, answer)) {
+        case PromptGate::Wait:
+            QTimer::singleShot(PromptGate::pollInterval, this, &AskPassService::takeTurn);
+            return;
+        case PromptGate::Decided:
+            break;
+        case PromptGate::Ask: {
+            // Held while the dialog is open, other calls meanwhile may find the wallet closed and open it anew
+            const std::shared_ptr<SecretStore> store = wallet(request.prompt);
+            WalletEntry entry(store.get(), request.prompt.identifier, request.prompt.type == TypePassword);
+            answered = askUser(request.prompt, entry, request.caller, answer, request.title);
+            m_gate->decide(answered, answer);
+            break;
+        }
+        }
+        finish(answered, answer);
+    }
+
+    // Replies to the request at the head of the queue and goes on with the next one.
+    void finish(bool answered, const QString &answer)
+    {
+        const Request request = m_queue.dequeue();
+        if (answered) {
+            QDBusConnection::sessionBus().send(request.message.createReply(replyText(answer)));
+        } else {
+            QDBusConnection::sessionBus().send(request.message.createErrorReply(QLatin1String(cancelledError), QStringLiteral("Canceled by the user")));
+        }
+
+        m_gate.reset();
+        m_asking = false;
+        QMetaObject::invokeMethod(this, &AskPassService::askNext, Qt::QueuedConnection);
+    }
+
+    // Each wallet is opened on the first prompt that may use it and kept open until it is closed, e.g. when the user
+    // locks it. One that can't be opened, or whose unlocking the user canceled, is tried again on the next prompt.
+    std::shared_ptr<SecretStore> wallet(const ParsedPrompt &prompt)
+    {
+        if (prompt.ignoreWallet && !prompt.retry) {
+            return nullptr;
+        }
+        const WalletLocation location = walletLocation(prompt.category);
+        const QString name = location.wallet + QLatin1Char('/') + location.folder;
+        auto it = m_wallets.find(name);
+        if (it != m_wallets.end() && !it->second->isOpen()) {
+            m_wallets.erase(it);
+            it = m_wallets.end();
+        }
+        if (it == m_wallets.end()) {
+            std::shared_ptr<SecretStore> store = openSecretStore(location);
+            if (!store) {
+                return nullptr;
+            }
+            it = m_wallets.emplace(name, std::move(store)).first;
+        }
+        return it->second;
+    }
+
+    std::map<QString, std::shared_ptr<SecretStore>> m_wallets;
+    QQueue<Request> m_queue;
+    // The request at the head of the queue is being asked, or waiting for its turn with m_gate
+    bool m_asking = false;
+    std::unique_ptr<PromptGate> m_gate;
+};
+}
+
+int runAskPassService()
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    AskPassService service;
+    if (!bus.registerObject(QLatin1String(objectPath), &service, QDBusConnection::ExportScriptableSlots)) {
+        qCWarning(LOG_KSSHASKPASS) << "Unable to export the AskPass interface:" << bus.lastError().message();
+        return 1;
+    }
+    if (!bus.registerService(QLatin1String(serviceName))) {
+        qCWarning(LOG_KSSHASKPASS) << "Unable to register" << serviceName << "on the session bus:" << bus.lastError().message();
+        return 1;
+    }
+
+#if HAVE_GUI
+    // Closing a dialog must not end the service
+    QGuiApplication::setQuitOnLastWindowClosed(false);
+#endif
+    return QCoreApplication::exec();
+}
+
+#include "askpassservice.moc"
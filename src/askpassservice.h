@@ -0,0 +1,11 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+// Serves org.kde.ksshaskpass on the session bus, so programs in the session can ask AskPass(prompt, hints) instead
+// of running ksshaskpass for every prompt. Answers come from the wallets, which are kept open between calls, and
+// from the same dialogs; callers are answered one dialog at a time. Returns the exit code.
+int runAskPassService();
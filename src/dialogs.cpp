@@ -0,0 +1,243 @@
+/*
+ *   SPDX-FileCopyrightText: 2006 Hans van Leeuwen <hanz@hanz.nl>
+ *   SPDX-FileCopyrightText: 2008-2010 Armin Berres <armin@space-based.de>
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "dialogs.h"
+
+#include "config-ksshaskpass.h"
+#include "keyverifier.h"
+
+#include <KLocalizedString>
+#if HAVE_GUI
+#include <KMessageBox>
+#include <KPasswordDialog>
+#include <KPasswordLineEdit>
+#include <kwidgetsaddons_version.h>
+
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QPointer>
+#include <QPushButton>
+#include <QVBoxLayout>
+#else
+#include "ttyprompt.h"
+#endif
+
+#include <sys/resource.h>
+
+static void disableCoreDumps()
+{
+    // We don't want to dump core when the password is being entered, because it could contain the entered password.
+    // KPasswordDialog::disableCoreDumps() seems to be gone in KDE 4 -- do it manually
+    struct rlimit rlim;
+    rlim.rlim_cur = rlim.rlim_max = 0;
+    setrlimit(RLIMIT_CORE, &rlim);
+}
+
+static QString titleOrDefault(const QString &title)
+{
+    return title.isEmpty() ? i18n("Ksshaskpass") : title;
+}
+
+#if HAVE_GUI
+// Password dialog that checks the passphrase against the key file before accepting it.
+class KeyPasswordDialog : public KPasswordDialog
+{
+public:
+    KeyPasswordDialog(const QString &keyFile, KPasswordDialog::KPasswordDialogFlags flags)
+        : KPasswordDialog(nullptr, flags)
+        , m_keyFile(keyFile)
+    {
+    }
+
+protected:
+    bool checkPassword() override
+    {
+        if (m_keyFile.isNull() || verifyKeyPassphrase(m_keyFile, password()) != KeyCheck::Mismatch) {
+            return true;
+        }
+        showErrorMessage(i18n("This passphrase does not unlock the key, please try again."), KPasswordDialog::PasswordError);
+        return false;
+    }
+
+private:
+    const QString m_keyFile;
+};
+
+bool askPassword(const PasswordQuestion &question, QString &answer, bool &keep)
+{
+    disableCoreDumps();
+
+    // Should use a dialog with visible input for clear text, but KPasswordDialog doesn't support that and
+    // other available dialog types don't have a "Keep" checkbox.
+    // create the password dialog, but only show "Enable Keep" button, if the wallet is open
+    KPasswordDialog::KPasswordDialogFlag flag(KPasswordDialog::NoFlags);
+    if (question.offerKeep) {
+        flag = KPasswordDialog::ShowKeepPassword;
+    }
+    QPointer<KPasswordDialog> kpd = new KeyPasswordDialog(question.keyFile, flag);
+
+    kpd->setPrompt(question.prompt);
+    kpd->setWindowTitle(titleOrDefault(question.title));
+    if (!question.error.isEmpty()) {
+        kpd->showErrorMessage(question.error, KPasswordDialog::PasswordError);
+    }
+
+    const bool accepted = kpd->exec() == QDialog::Accepted;
+    if (kpd && accepted) {
+        answer = kpd->password();
+        keep = kpd->keepPassword();
+    }
+    delete kpd;
+    return accepted;
+}
+
+// The current password and the new one twice, which can only be accepted once the new ones match.
+class PasswordChangeDialog : public QDialog
+{
+public:
+    explicit PasswordChangeDialog(const QString &prompt)
+    {
+        auto *layout = new QVBoxLayout(this);
+        auto *label = new QLabel(prompt);
+        label->setWordWrap(true);
+        layout->addWidget(label);
+
+        auto *form = new QFormLayout;
+        m_old = new KPasswordLineEdit;
+        m_new = new KPasswordLineEdit;
+        m_retype = new KPasswordLineEdit;
+        form->addRow(i18n("Current password:"), m_old);
+        form->addRow(i18n("New password:"), m_new);
+        form->addRow(i18n("Retype new password:"), m_retype);
+        layout->addLayout(form);
+
+        m_mismatch = new QLabel(i18n("The new passwords do not match."));
+        layout->addWidget(m_mismatch);
+
+        m_buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+        connect(m_buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+        connect(m_buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+        layout->addWidget(m_buttons);
+
+        for (KPasswordLineEdit *edit : {m_old, m_new, m_retype}) {
+            connect(edit, &KPasswordLineEdit::passwordChanged, this, &PasswordChangeDialog::updateButtons);
+        }
+        updateButtons();
+    }
+
+    QString oldPassword() const
+    {
+        return m_old->password();
+    }
+
+    QString newPassword() const
+    {
+        return m_new->password();
+    }
+
+private:
+    void updateButtons()
+    {
+        const bool matching = m_new->password() == m_retype->password();
+        m_mismatch->setVisible(!matching && !m_retype->password().isEmpty());
+        m_buttons->button(QDialogButtonBox::Ok)->setEnabled(matching && !m_old->password().isEmpty() && !m_new->password().isEmpty());
+    }
+
+    KPasswordLineEdit *m_old;
+    KPasswordLineEdit *m_new;
+    KPasswordLineEdit *m_retype;
+    QLabel *m_mismatch;
+    QDialogButtonBox *m_buttons;
+};
+
+bool askPasswordChange(const QString &prompt, QString &oldPassword, QString &newPassword)
+{
+    disableCoreDumps();
+
+    QPointer<PasswordChangeDialog> dialog = new PasswordChangeDialog(prompt);
+    dialog->setWindowTitle(titleOrDefault(QString()));
+    const bool accepted = dialog->exec() == QDialog::Accepted;
+    if (dialog && accepted) {
+        oldPassword = dialog->oldPassword();
+        newPassword = dialog->newPassword();
+    }
+    delete dialog;
+    return accepted;
+}
+
+bool askConfirmation(const QString &prompt, const QString &title)
+{
+#if KWIDGETSADDONS_VERSION >= QT_VERSION_CHECK(5, 100, 0)
+    return KMessageBox::questionTwoActions(nullptr,
+                                           prompt,
+                                           titleOrDefault(title),
+                                           KGuiItem(i18nc("@action:button", "Accept"), QStringLiteral("dialog-ok")),
+                                           KStandardGuiItem::cancel())
+        == KMessageBox::PrimaryAction;
+#else
+    return KMessageBox::questionYesNo(nullptr, prompt, titleOrDefault(title)) == KMessageBox::Yes;
+#endif
+}
+
+void showMessage(const QString &message, const QString &title)
+{
+    KMessageBox::information(nullptr, message, titleOrDefault(title));
+}
+#else
+bool askPassword(const PasswordQuestion &question, QString &answer, bool &keep)
+{
+    disableCoreDumps();
+
+    if (!question.error.isEmpty()) {
+        writeToTerminal(question.error + QLatin1Char('\n'));
+    }
+    for (int attempt = 0;; ++attempt) {
+        if (!readFromTerminal(question.prompt, question.clearText, answer)) {
+            return false;
+        }
+        if (question.keyFile.isNull() || attempt == 2 || verifyKeyPassphrase(question.keyFile, answer) != KeyCheck::Mismatch) {
+            break;
+        }
+        writeToTerminal(i18n("This passphrase does not unlock the key, please try again.") + QLatin1Char('\n'));
+    }
+    keep = question.offerKeep && confirmOnTerminal(i18n("Keep the answer?"));
+    return true;
+}
+
+bool askPasswordChange(const QString &prompt, QString &oldPassword, QString &newPassword)
+{
+    disableCoreDumps();
+
+    writeToTerminal(prompt + QLatin1Char('\n'));
+    if (!readFromTerminal(i18n("Current password: "), false, oldPassword)) {
+        return false;
+    }
+    for (;;) {
+        QString retyped;
+        if (!readFromTerminal(i18n("New password: "), false, newPassword) || !readFromTerminal(i18n("Retype new password: "), false, retyped)) {
+            return false;
+        }
+        if (newPassword == retyped) {
+            return true;
+        }
+        writeToTerminal(i18n("The new passwords do not match.") + QLatin1Char('\n'));
+    }
+}
+
+bool askConfirmation(const QString &prompt, const QString &title)
+{
+    Q_UNUSED(title)
+    return confirmOnTerminal(prompt);
+}
+
+void showMessage(const QString &message, const QString &title)
+{
+    Q_UNUSED(title)
+    writeToTerminal(message + QLatin1Char('\n'));
+}
+#endif
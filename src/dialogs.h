@@ -0,0 +1,36 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QString>
+
+// What to ask the user for a passphrase, PIN or other answer.
+struct PasswordQuestion {
+    QString prompt;
+    // Window title, "Ksshaskpass" if empty.
+    QString title;
+    // Shown along with the prompt, e.g. after a wrong answer.
+    QString error;
+    // If set, the answer is checked against this key file before it is accepted.
+    QString keyFile;
+    bool clearText = false;
+    // Whether to offer keeping the answer in the wallet.
+    bool offerKeep = false;
+};
+
+// Asks the user with a dialog, or on the terminal if ksshaskpass is built without dialogs. Returns false if the
+// user canceled. keep is set if the user asked to keep the answer.
+bool askPassword(const PasswordQuestion &question, QString &answer, bool &keep);
+
+// Asks for the current password and a new one, which has to be typed twice, in one go. Returns false if the user
+// canceled.
+bool askPasswordChange(const QString &prompt, QString &oldPassword, QString &newPassword);
+
+// Asks the user to accept or cancel. Returns false if the user canceled.
+bool askConfirmation(const QString &prompt, const QString &title = QString());
+
+// Shows a message the user can only acknowledge.
+void showMessage(const QString &message, const QString &title = QString());
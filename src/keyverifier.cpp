@@ -0,0 +1,85 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "keyverifier.h"
+
+#include "ksshaskpass_debug.h"
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QProcessEnvironment>
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// The passphrase goes to the ksshaskpass that ssh-keygen starts through a pipe, whose read end ssh-keygen inherits
+// and passes on. Only the number of that file descriptor is put into the environment, which every descendant of
+// ssh-keygen inherits.
+static const char answerFdVariable[] = "KSSHASKPASS_VERIFY_FD";
+
+KeyCheck verifyKeyPassphrase(const QString &keyFile, const QString &passphrase)
+{
+    int answerPipe[2];
+    if (pipe(answerPipe) != 0) {
+        qCWarning(LOG_KSSHASKPASS) << "Unable to check the passphrase, no pipe for it";
+        return KeyCheck::Unknown;
+    }
+    // A passphrase fits into the buffer of the pipe, so it is written right away and only the read end is left
+    const QByteArray answer = passphrase.toUtf8() + '\n';
+    const bool written = write(answerPipe[1], answer.constData(), answer.size()) == answer.size();
+    close(answerPipe[1]);
+    if (!written) {
+        close(answerPipe[0]);
+        return KeyCheck::Unknown;
+    }
+
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QStringLiteral("SSH_ASKPASS"), QCoreApplication::applicationFilePath());
+    environment.insert(QStringLiteral("SSH_ASKPASS_REQUIRE"), QStringLiteral("force"));
+    environment.insert(QString::fromLatin1(answerFdVariable), QString::number(answerPipe[0]));
+
+    QProcess keygen;
+    keygen.setProcessEnvironment(environment);
+    keygen.setStandardInputFile(QProcess::nullDevice());
+    keygen.start(QStringLiteral("ssh-keygen"), {QStringLiteral("-y"), QStringLiteral("-f"), keyFile});
+    const bool finished = keygen.waitForStarted() && keygen.waitForFinished();
+
+    // ssh-keygen only tried the passphrase if its askpass read it. OpenSSH before 8.4 ignores SSH_ASKPASS_REQUIRE
+    // and, without a display, tries an empty passphrase instead, which fails the same way a wrong one does.
+    int unread = -1;
+    const bool asked = ioctl(answerPipe[0], FIONREAD, &unread) == 0 && unread == 0;
+    close(answerPipe[0]);
+
+    if (!finished) {
+        qCWarning(LOG_KSSHASKPASS) << "Unable to check the passphrase with ssh-keygen:" << keygen.errorString();
+        keygen.kill();
+        return KeyCheck::Unknown;
+    }
+    if (keygen.exitStatus() == QProcess::NormalExit && keygen.exitCode() == 0) {
+        return KeyCheck::Matches;
+    }
+    if (asked && keygen.readAllStandardError().contains("incorrect passphrase")) {
+        return KeyCheck::Mismatch;
+    }
+    return KeyCheck::Unknown;
+}
+
+bool answerKeyVerification()
+{
+    bool isSet = false;
+    const int fd = qEnvironmentVariableIntValue(answerFdVariable, &isSet);
+    if (!isSet) {
+        return false;
+    }
+    char buffer[1024];
+    ssize_t size;
+    while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+        fwrite(buffer, 1, size, stdout);
+    }
+    close(fd);
+    return true;
+}
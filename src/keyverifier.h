@@ -0,0 +1,23 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QString>
+
+enum class KeyCheck {
+    Matches,
+    Mismatch,
+    Unknown,
+};
+
+// Checks a passphrase against a private key file before it is handed to ssh-add, so a wrong one doesn't cost
+// another round of ssh-add and ksshaskpass. ssh-keygen does the actual decryption, and asks us for the passphrase
+// through SSH_ASKPASS. Returns Unknown if the key couldn't be checked.
+KeyCheck verifyKeyPassphrase(const QString &keyFile, const QString &passphrase);
+
+// Answers the prompt of the ssh-keygen started by verifyKeyPassphrase(). Returns false if this process wasn't
+// started for that.
+bool answerKeyVerification();
@@ -0,0 +1,211 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kwalletstore.h"
+
+#include "ksshaskpass_debug.h"
+#include "sessioncache.h"
+
+#include <kwallet.h>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+
+#include <vector>
+
+// Remembered in the session cache once the wallet turned out to be unavailable, so later prompts don't check again
+static const int unavailableCacheTime = 600;
+
+// The session cache is shared by every login of the user, the marker only speaks for the session bus it was found
+// on. A null string if there is no way to tell sessions apart.
+static QString unavailableMarker()
+{
+    QByteArray session = qgetenv("DBUS_SESSION_BUS_ADDRESS");
+    if (session.isEmpty()) {
+        session = qgetenv("XDG_SESSION_ID");
+    }
+    if (session.isEmpty()) {
+        return QString();
+    }
+    return QLatin1String("kwallet-unavailable:") + QString::fromLatin1(QCryptographicHash::hash(session, QCryptographicHash::Sha256).toHex());
+}
+
+// Whether opening the wallet can possibly succeed: KWallet is enabled, and its daemon, or the Secret Service it
+// may be configured to use, runs or can be started by the bus. Without this check every prompt would wait for
+// the open to fail on desktops that don't use KWallet.
+static bool isWalletAvailable()
+{
+    const QString marker = unavailableMarker();
+    if (!marker.isNull() && !SessionCache::lookup(marker).isNull()) {
+        return false;
+    }
+
+    bool available = false;
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    if (bus && KWallet::Wallet::isEnabled()) {
+        const QStringList services = {QStringLiteral("org.kde.kwalletd6"), QStringLiteral("org.kde.kwalletd5"), QStringLiteral("org.freedesktop.secrets")};
+        for (const QString &service : services) {
+            if (bus->isServiceRegistered(service)) {
+                available = true;
+                break;
+            }
+        }
+        if (!available) {
+            const QStringList activatable = bus->activatableServiceNames();
+            for (const QString &service : services) {
+                if (activatable.contains(service)) {
+                    available = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!available) {
+        qCDebug(LOG_KSSHASKPASS) << "KWallet is disabled or not installed, not opening it";
+        // Without a session bus, e.g. in a cron job, nothing is known about the desktop session
+        if (bus && !marker.isNull()) {
+            SessionCache::store(marker, QByteArrayLiteral("1"), unavailableCacheTime);
+        }
+    }
+    return available;
+}
+
+KWalletStore::KWalletStore(KWallet::Wallet *wallet, const WalletLocation &location)
+    : SecretStore(location)
+    , m_wallet(wallet)
+    , m_folder(location.folder)
+{
+    // Patterns other programs add, e.g. in KWalletManager, go to .patterns while a process with the folder open
+    // runs, like the one started with --warmup. Writing .patterns updates the folder too, but only once, as the
+    // list is only written when it changed.
+    QObject::connect(m_wallet.get(), &KWallet::Wallet::folderUpdated, m_wallet.get(), [this](const QString &updated) {
+        if (updated == m_folder) {
+            refreshPatterns();
+        }
+    });
+}
+
+KWalletStore::~KWalletStore() = default;
+
+static QString walletName(const QString &name)
+{
+    if (name == QLatin1String("NetworkWallet")) {
+        return KWallet::Wallet::NetworkWallet();
+    }
+    if (name == QLatin1String("LocalWallet")) {
+        return KWallet::Wallet::LocalWallet();
+    }
+    return name;
+}
+
+std::unique_ptr<KWalletStore> KWalletStore::open(const WalletLocation &location)
+{
+    if (!isWalletAvailable()) {
+        return nullptr;
+    }
+    KWallet::Wallet *wallet = KWallet::Wallet::openWallet(walletName(location.wallet), 0);
+    if (!wallet) {
+        return nullptr;
+    }
+    return std::unique_ptr<KWalletStore>(new KWalletStore(wallet, location));
+}
+
+int KWalletStore::keepOpen(const QList<WalletLocation> &locations)
+{
+    // KWallet may have been set up since a prompt found it unavailable
+    const QString marker = unavailableMarker();
+    if (!marker.isNull()) {
+        SessionCache::remove(marker);
+    }
+    std::vector<std::unique_ptr<KWalletStore>> stores;
+    for (const WalletLocation &location : locations) {
+        std::unique_ptr<KWalletStore> store = open(location);
+        if (!store || !store->enterFolder(true)) {
+            qCWarning(LOG_KSSHASKPASS) << "Unable to open the folder" << location.folder << "of the wallet" << location.wallet;
+            return 1;
+        }
+        QObject::connect(store->m_wallet.get(), &KWallet::Wallet::walletClosed, QCoreApplication::instance(), &QCoreApplication::quit);
+        stores.push_back(std::move(store));
+    }
+    return QCoreApplication::exec();
+}
+
+bool KWalletStore::enterFolder(bool create)
+{
+    if (m_inFolder) {
+        return true;
+    }
+    if (!m_wallet->hasFolder(m_folder)) {
+        if (!create || !m_wallet->createFolder(m_folder)) {
+            return false;
+        }
+    }
+    m_inFolder = m_wallet->setFolder(m_folder);
+    return m_inFolder;
+}
+
+QString KWalletStore::readPassword(const QString &key)
+{
+    QString value;
+    if (!enterFolder(false) || m_wallet->readPassword(key, value) != 0) {
+        return QString();
+    }
+    return value;
+}
+
+bool KWalletStore::writePassword(const QString &key, const QString &value)
+{
+    if (!enterFolder(true) || m_wallet->writePassword(key, value) != 0) {
+        return false;
+    }
+    updatePatterns(QString(), key);
+    return true;
+}
+
+bool KWalletStore::renameEntry(const QString &oldKey, const QString &newKey)
+{
+    if (!enterFolder(false) || m_wallet->renameEntry(oldKey, newKey) != 0) {
+        return false;
+    }
+    updatePatterns(oldKey, newKey);
+    return true;
+}
+
+bool KWalletStore::removeEntry(const QString &key)
+{
+    if (!enterFolder(false) || m_wallet->removeEntry(key) != 0) {
+        return false;
+    }
+    updatePatterns(key, QString());
+    return true;
+}
+
+QStringList KWalletStore::entryList()
+{
+    return enterFolder(false) ? m_wallet->entryList() : QStringList();
+}
+
+QMap<QString, QString> KWalletStore::readMap(const QString &key)
+{
+    QMap<QString, QString> value;
+    if (!enterFolder(false) || m_wallet->readMap(key, value) != 0) {
+        return QMap<QString, QString>();
+    }
+    return value;
+}
+
+bool KWalletStore::writeMap(const QString &key, const QMap<QString, QString> &value)
+{
+    return enterFolder(true) && m_wallet->writeMap(key, value) == 0;
+}
+
+bool KWalletStore::isOpen() const
+{
+    // KWallet::Wallet notices walletClosed by itself
+    return m_wallet->isOpen();
+}
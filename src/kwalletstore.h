@@ -0,0 +1,47 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "secretstore.h"
+
+namespace KWallet
+{
+class Wallet;
+}
+
+class KWalletStore : public SecretStore
+{
+public:
+    ~KWalletStore() override;
+
+    // Opens the wallet synchronously, returns nullptr if that fails.
+    static std::unique_ptr<KWalletStore> open(const WalletLocation &location);
+
+    // Opens the wallets, creates the folders in them if needed and keeps them open until one is closed, so the
+    // first prompt of a session doesn't wait for kwalletd to start and the wallets to be unlocked. Returns the
+    // exit code.
+    static int keepOpen(const QList<WalletLocation> &locations);
+
+    QString readPassword(const QString &key) override;
+    bool writePassword(const QString &key, const QString &value) override;
+    bool renameEntry(const QString &oldKey, const QString &newKey) override;
+    bool removeEntry(const QString &key) override;
+    QStringList entryList() override;
+    QMap<QString, QString> readMap(const QString &key) override;
+    bool writeMap(const QString &key, const QMap<QString, QString> &value) override;
+    bool isOpen() const override;
+
+private:
+    KWalletStore(KWallet::Wallet *wallet, const WalletLocation &location);
+
+    // Makes m_folder the current folder, optionally creating it first. Each of these is a D-Bus call, so it is
+    // only done the first time.
+    bool enterFolder(bool create);
+
+    std::unique_ptr<KWallet::Wallet> m_wallet;
+    const QString m_folder;
+    bool m_inFolder = false;
+};
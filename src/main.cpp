@@ -4,244 +4,98 @@
  *   SPDX-License-Identifier: GPL-2.0-or-later
  */
 
+#include <cerrno>
+#include <cstring>
 #include <memory>
 #include <sys/resource.h>
+#include <unistd.h>
+
+#include "answer.h"
+#include "config-ksshaskpass.h"
+#include "keyverifier.h"
+#include "ksshaskpass_debug.h"
+#include "pinentry.h"
+#include "resulttable.h"
+#include "secretstore.h"
+#include "walletentry.h"
+#if HAVE_DBUS
+#include "askpassservice.h"
+#endif
+#if HAVE_KWALLET
+#include "kwalletstore.h"
+#endif
 
 #include <KAboutData>
 #include <KLocalizedString>
-#include <KMessageBox>
-#include <KPasswordDialog>
-#include <kwallet.h>
-#include <kwidgetsaddons_version.h>
-
+#if HAVE_GUI
 #include <QApplication>
+#include <QIcon>
+#include <QLibraryInfo>
+#endif
+
 #include <QCommandLineOption>
 #include <QCommandLineParser>
-#include <QInputDialog>
-#include <QLoggingCategory>
-#include <QPointer>
-#include <QRegularExpression>
+#include <QCoreApplication>
+#include <QFile>
 #include <QTextStream>
+#if HAVE_GUI && HAVE_PGO_INSTRUMENTATION
+#include <QTimer>
+#endif
 
-Q_LOGGING_CATEGORY(LOG_KSSHASKPASS, "ksshaskpass")
-
-enum Type {
-    TypePassword,
-    TypeClearText,
-    TypeConfirm,
-};
+#if HAVE_PGO_INSTRUMENTATION && defined(__clang__)
+// GCC's instrumentation writes the profile before an exec by itself, clang's runtime only does on exit
+extern "C" int __llvm_profile_write_file(void);
+#endif
 
-// Try to understand what we're asked for by parsing the phrase. Unfortunately, sshaskpass interface does not
-// include any saner methods to pass the action or the name of the keyfile. Fortunately, openssh and git
-// has no i18n, so this should work for all languages as long as the string is unchanged.
-static void parsePrompt(const QString &prompt, QString &identifier, bool &ignoreWallet, enum Type &type)
+#if HAVE_GUI
+// QApplication looks for platform, style, icon engine and input context plugins in every library path, which
+// includes the directory of the executable as well as Qt's own plugin directory. We only ever need what Qt
+// itself ships, so the other directories aren't searched. Anything the user set explicitly is left alone.
+static void restrictPluginDiscovery()
 {
-    QRegularExpressionMatch match;
-
-    // openssh sshconnect2.c
-    // Case: password for authentication on remote ssh server
-    match = QRegularExpression(QStringLiteral("^(.*@.*)'s password( \\(JPAKE\\))?: $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypePassword;
-        ignoreWallet = false;
-        return;
-    }
-
-    // openssh sshconnect2.c
-    // Case: password change request
-    match = QRegularExpression(QStringLiteral("^(Enter|Retype) (.*@.*)'s (old|new) password: $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(2);
-        type = TypePassword;
-        ignoreWallet = true;
-        return;
-    }
-
-    // openssh sshconnect2.c and sshconnect1.c
-    // Case: asking for passphrase for a certain keyfile
-    match = QRegularExpression(QStringLiteral("^Enter passphrase for( RSA)? key '(.*)': $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(2);
-        type = TypePassword;
-        ignoreWallet = false;
-        return;
-    }
-
-    // openssh ssh-add.c
-    // Case: asking for passphrase for a certain keyfile for the first time => we should try a password from the wallet
-    match = QRegularExpression(QStringLiteral("^Enter passphrase for (.*?)( \\(will confirm each use\\))?: $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypePassword;
-        ignoreWallet = false;
-        return;
-    }
-
-    // openssh ssh-add.c
-    // Case: re-asking for passphrase for a certain keyfile => probably we've tried a password from the wallet, no point
-    // in trying it again
-    match = QRegularExpression(QStringLiteral("^Bad passphrase, try again for (.*?)( \\(will confirm each use\\))?: $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypePassword;
-        ignoreWallet = true;
-        return;
-    }
-
-    // openssh ssh-pkcs11.c
-    // Case: asking for PIN for some token label
-    match = QRegularExpression(QStringLiteral("Enter PIN for '(.*)': $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypePassword;
-        ignoreWallet = false;
-        return;
-    }
-
-    // openssh mux.c
-    match = QRegularExpression(QStringLiteral("^(Allow|Terminate) shared connection to (.*)\\? $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(2);
-        type = TypeConfirm;
-        ignoreWallet = true;
-        return;
-    }
-
-    // openssh mux.c
-    match = QRegularExpression(QStringLiteral("^Open (.* on .*)?$")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypeConfirm;
-        ignoreWallet = true;
-        return;
-    }
-
-    // openssh mux.c
-    match = QRegularExpression(QStringLiteral("^Allow forward to (.*:.*)\\? $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypeConfirm;
-        ignoreWallet = true;
-        return;
-    }
-
-    // openssh mux.c
-    match = QRegularExpression(QStringLiteral("^Disable further multiplexing on shared connection to (.*)? $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypeConfirm;
-        ignoreWallet = true;
-        return;
-    }
-
-    // openssh ssh-agent.c
-    match = QRegularExpression(QStringLiteral("^Allow use of key (.*)?\\nKey fingerprint .*\\.$")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypeConfirm;
-        ignoreWallet = true;
-        return;
-    }
-
-    // openssh sshconnect.c
-    match = QRegularExpression(QStringLiteral("^Add key (.*) \\(.*\\) to agent\\?$")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypeConfirm;
-        ignoreWallet = true;
-        return;
-    }
-
-    // git imap-send.c
-    // Case: asking for password by git imap-send
-    match = QRegularExpression(QStringLiteral("^Password \\((.*@.*)\\): $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypePassword;
-        ignoreWallet = false;
-        return;
-    }
-
-    // git credential.c
-    // Case: asking for username by git without specifying any other information
-    match = QRegularExpression(QStringLiteral("^Username: $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = QString();
-        type = TypeClearText;
-        ignoreWallet = true;
-        return;
-    }
-
-    // git credential.c
-    // Case: asking for password by git without specifying any other information
-    match = QRegularExpression(QStringLiteral("^Password: $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = QString();
-        type = TypePassword;
-        ignoreWallet = true;
-        return;
-    }
-
-    // git credential.c
-    // Case: asking for username by git for some identifier
-    match = QRegularExpression(QStringLiteral("^Username for '(.*)': $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypeClearText;
-        ignoreWallet = false;
-        return;
-    }
-
-    // git credential.c
-    // Case: asking for password by git for some identifier
-    match = QRegularExpression(QStringLiteral("^Password for '(.*)': $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypePassword;
-        ignoreWallet = false;
-        return;
-    }
-
-    // Case: username extraction from git-lfs
-    match = QRegularExpression(QStringLiteral("^Username for \"(.*?)\"$")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypeClearText;
-        ignoreWallet = false;
-        return;
+    if (qEnvironmentVariableIsEmpty("QT_PLUGIN_PATH")) {
+        QCoreApplication::setLibraryPaths({QLibraryInfo::path(QLibraryInfo::PluginsPath)});
     }
+}
+#endif
 
-    // Case: password extraction from git-lfs
-    match = QRegularExpression(QStringLiteral("^Password for \"(.*?)\"$")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypePassword;
-        ignoreWallet = false;
-        return;
+// Set in the environment when we execute ourselves again after the wallet lookup came up empty, the second one if
+// the wallet could be opened for it.
+static const char lookupDoneVariable[] = "KSSHASKPASS_LOOKUP_DONE";
+static const char walletOpenedVariable[] = "KSSHASKPASS_WALLET_OPENED";
+
+// Logs peak and private memory use on exit, enable with QT_LOGGING_RULES="ksshaskpass.debug=true".
+// tools/measure-memory.sh checks the wallet hit against its budget with this, a wallet hit should never load widgets.
+struct MemoryReport {
+    ~MemoryReport()
+    {
+        if (!LOG_KSSHASKPASS().isDebugEnabled()) {
+            return;
+        }
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            qCDebug(LOG_KSSHASKPASS) << "Peak resident set size:" << usage.ru_maxrss << "KiB";
+        }
+        QFile rollup(QStringLiteral("/proc/self/smaps_rollup"));
+        if (rollup.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            for (const QByteArray &line : rollup.readAll().split('\n')) {
+                if (line.startsWith("Rss:") || line.startsWith("Private_Dirty:")) {
+                    qCDebug(LOG_KSSHASKPASS) << line.simplified().constData();
+                }
+            }
+        }
     }
+};
 
-    // Case: password extraction from mercurial, see bug 380085
-    match = QRegularExpression(QStringLiteral("^(.*?)'s password: $")).match(prompt);
-    if (match.hasMatch()) {
-        identifier = match.captured(1);
-        type = TypePassword;
-        ignoreWallet = false;
+// The about data is only shown by --help, --version and the dialogs, and building it costs a round of
+// translation lookups, so it is set up on demand.
+static void setupAboutData()
+{
+    static bool done = false;
+    if (done) {
         return;
     }
-
-    // Nothing matched; either it was called by some sort of a script with a custom prompt (i.e. not ssh-add), or
-    // strings we're looking for were broken. Issue a warning and continue without identifier.
-    qCWarning(LOG_KSSHASKPASS) << "Unable to parse phrase" << prompt;
-}
-
-int main(int argc, char **argv)
-{
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-    QGuiApplication::setAttribute(Qt::AA_UseHighDpiPixmaps, true);
-#endif
-    QApplication app(argc, argv);
-    KLocalizedString::setApplicationDomain("ksshaskpass");
+    done = true;
 
     // TODO update it.
     KAboutData about(QStringLiteral("ksshaskpass"),
@@ -258,112 +112,198 @@ int main(int argc, char **argv)
     about.addAuthor(i18n("Hans van Leeuwen"), i18n("Original author"), QStringLiteral("hanz@hanz.nl"));
     about.addAuthor(i18n("Pali Rohár"), i18n("Contributor"), QStringLiteral("pali.rohar@gmail.com"));
     KAboutData::setApplicationData(about);
+}
+
+// Parses the full command line, handling --help, --version and friends on the way.
+static void parseCommandLine(const QCoreApplication &app, QCommandLineParser &parser)
+{
+    setupAboutData();
+    KAboutData about = KAboutData::applicationData();
 
-    QCommandLineParser parser;
     about.setupCommandLine(&parser);
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("+[prompt]"), i18nc("Name of a prompt for a password", "Prompt")));
+    parser.addOption(QCommandLineOption(QStringLiteral("group"),
+                                        i18n("Let the key files given as arguments share the passphrase stored for <name>"),
+                                        i18nc("Name of a group of keys sharing a passphrase", "name")));
+#if HAVE_KWALLET
+    parser.addOption(QCommandLineOption(QStringLiteral("warmup"), i18n("Open the wallet and keep it open, to be run at login")));
+#endif
+#if HAVE_DBUS
+    parser.addOption(QCommandLineOption(QStringLiteral("dbus-service"), i18n("Answer prompts of programs in the session over D-Bus")));
+#endif
 
     parser.process(app);
     about.processCommandLine(&parser);
+}
 
-    const QString walletFolder = app.applicationName();
-    QString dialog = i18n("Please enter passphrase"); // Default dialog text.
-    QString identifier;
-    QString item;
-    bool ignoreWallet = false;
-    enum Type type = TypePassword;
+// Creates the application, with widgets only if they are needed and available.
+static std::unique_ptr<QCoreApplication> createApplication(int &argc, char **argv, bool withGui)
+{
+    std::unique_ptr<QCoreApplication> app;
+#if HAVE_GUI
+    if (withGui) {
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+        QGuiApplication::setAttribute(Qt::AA_UseHighDpiPixmaps, true);
+#endif
+        restrictPluginDiscovery();
+        app.reset(new QApplication(argc, argv));
+#if HAVE_PGO_INSTRUMENTATION
+        // Training runs of tools/pgo-train.sh have nobody to answer the dialogs. They are canceled once shown, so
+        // the process exits normally and writes its profile.
+        if (qEnvironmentVariableIsSet("KSSHASKPASS_PGO_TRAINING")) {
+            QTimer::singleShot(300, app.get(), [] {
+                QCoreApplication::exit(1);
+            });
+        }
+#endif
+#if HAVE_EMBEDDED_ICONS
+        // Looking up a themed icon walks the index files of the theme and everything it inherits from, in every
+        // icon directory, before the first dialog can be drawn. With a theme set by the application Qt resolves
+        // icons itself instead of through the platform's icon engine, and this one only lives in our resources.
+        QIcon::setThemeSearchPaths({QStringLiteral(":/icons")});
+        QIcon::setThemeName(QStringLiteral("ksshaskpass"));
+#endif
+    }
+#else
+    Q_UNUSED(withGui)
+#endif
+    if (!app) {
+        app.reset(new QCoreApplication(argc, argv));
+    }
+    KLocalizedString::setApplicationDomain("ksshaskpass");
+    QCoreApplication::setApplicationName(QStringLiteral("ksshaskpass"));
+    return app;
+}
 
-    // Parse commandline arguments
-    if (!parser.positionalArguments().isEmpty()) {
-        dialog = parser.positionalArguments().at(0);
-        parsePrompt(dialog, identifier, ignoreWallet, type);
+int main(int argc, char **argv)
+{
+    // ssh-keygen asking for the passphrase we are verifying
+    if (answerKeyVerification()) {
+        return 0;
     }
 
-    // Open KWallet to see if an item was previously stored
-    std::unique_ptr<KWallet::Wallet> wallet(ignoreWallet ? nullptr : KWallet::Wallet::openWallet(KWallet::Wallet::NetworkWallet(), 0));
+    MemoryReport memoryReport;
 
-    if ((!ignoreWallet) && (!identifier.isNull()) && wallet.get() && wallet->hasFolder(walletFolder)) {
-        wallet->setFolder(walletFolder);
+    // gpg-agent may pass options meant for other pinentries, so the command line is not parsed
+    if (isPinentryInvocation(argc, argv)) {
+        std::unique_ptr<QCoreApplication> app = createApplication(argc, argv, true);
+        setupAboutData();
+        return runPinentry(walletLocation(CategoryGpg));
+    }
 
-        wallet->readPassword(identifier, item);
+    ParsedPrompt prompt;
 
-        if (item.isEmpty()) {
-            // There was a bug in previous versions of ksshaskpass that caused it to create keys with single quotes
-            // around the identifier and even older versions have an extra space appended to the identifier.
-            // key file name. Try these keys too, and, if there's a match, ensure that it's properly
-            // replaced with proper one.
-            for (auto templ : QStringList{QStringLiteral("'%0'"), QStringLiteral("%0 "), QStringLiteral("'%0' ")}) {
-                const QString keyFile = templ.arg(identifier);
-                wallet->readPassword(keyFile, item);
-                if (!item.isEmpty()) {
-                    qCWarning(LOG_KSSHASKPASS) << "Detected legacy key for " << identifier << ", enabling workaround";
-                    wallet->renameEntry(keyFile, identifier);
-                    break;
-                }
-            }
-        }
+    // Parse commandline arguments. The usual "ksshaskpass <prompt>" call doesn't need the full parser.
+    const bool plainCall = argc == 1 || (argc == 2 && argv[1][0] != '-');
+    if (argc == 2 && plainCall) {
+        prompt = ParsedPrompt(QString::fromLocal8Bit(argv[1]), getppid());
     }
 
-    if (!item.isEmpty()) {
-        QTextStream(stdout) << item;
-        return 0;
+    // Answering from the wallet needs neither widgets nor a connection to the display server, and those make up
+    // most of the memory of a ksshaskpass process. So if the wallet may know the answer we look it up in a
+    // QCoreApplication, and only execute ourselves again with dialogs if it doesn't.
+    const bool lookupDone = qEnvironmentVariableIsSet(lookupDoneVariable);
+    const bool walletOpened = qEnvironmentVariableIsSet(walletOpenedVariable);
+    qunsetenv(lookupDoneVariable);
+    qunsetenv(walletOpenedVariable);
+    const bool mayBeKnown = !prompt.ignoreWallet || prompt.sessionOnly || prompt.passwordChange == PasswordChangeNew
+        || prompt.passwordChange == PasswordChangeRetype || (prompt.type == TypeConfirm && ResultTable::exists());
+    const bool coreOnly = !HAVE_GUI || (plainCall && !lookupDone && mayBeKnown && !prompt.identifier.isNull());
+
+    // --warmup stays around for the whole session without ever showing a dialog
+    bool warmup = false;
+#if HAVE_KWALLET
+    for (int i = 1; i < argc && !plainCall && !warmup; ++i) {
+        warmup = qstrcmp(argv[i], "--warmup") == 0;
     }
+#endif
 
-    // Item could not be retrieved from wallet. Open dialog
-    switch (type) {
-    case TypeConfirm: {
-#if KWIDGETSADDONS_VERSION >= QT_VERSION_CHECK(5, 100, 0)
-        if (KMessageBox::questionTwoActions(nullptr,
-                                            dialog,
-                                            i18n("Ksshaskpass"),
-                                            KGuiItem(i18nc("@action:button", "Accept"), QStringLiteral("dialog-ok")),
-                                            KStandardGuiItem::cancel())
-            != KMessageBox::PrimaryAction) {
-#else
-        if (KMessageBox::questionYesNo(nullptr, dialog, i18n("Ksshaskpass")) != KMessageBox::Yes) {
+    std::unique_ptr<QCoreApplication> app = createApplication(argc, argv, !coreOnly && !warmup);
+
+    if (!plainCall) {
+        QCommandLineParser parser;
+        parseCommandLine(*app, parser);
+        if (parser.isSet(QStringLiteral("group"))) {
+            // Alias groups are meant for keys sharing a passphrase, and live with key passphrases
+            std::unique_ptr<SecretStore> wallet(openSecretStore(walletLocation(CategoryKey)));
+            if (!wallet) {
+                qCWarning(LOG_KSSHASKPASS) << "Unable to open the wallet";
+                return 1;
+            }
+            return addToAliasGroup(*wallet, parser.value(QStringLiteral("group")), parser.positionalArguments()) ? 0 : 1;
+        }
+#if HAVE_KWALLET
+        if (parser.isSet(QStringLiteral("warmup"))) {
+            return KWalletStore::keepOpen(walletLocations());
+        }
+#endif
+#if HAVE_DBUS
+        if (parser.isSet(QStringLiteral("dbus-service"))) {
+            return runAskPassService();
+        }
 #endif
-            // dialog has been canceled
-            return 1;
+        const QString text = parser.positionalArguments().value(0);
+        if (!text.isNull()) {
+            prompt = ParsedPrompt(text, getppid());
         }
-        item = QStringLiteral("yes\n");
-        break;
     }
-    case TypeClearText:
-        // Should use a dialog with visible input, but KPasswordDialog doesn't support that and
-        // other available dialog types don't have a "Keep" checkbox.
-        /* fallthrough */
-    case TypePassword: {
-        // create the password dialog, but only show "Enable Keep" button, if the wallet is open
-        KPasswordDialog::KPasswordDialogFlag flag(KPasswordDialog::NoFlags);
-        if (wallet.get()) {
-            flag = KPasswordDialog::ShowKeepPassword;
+    if (prompt.text.isNull()) {
+        prompt.text = i18n("Please enter passphrase"); // Default dialog text.
+    }
+
+    // An answer given a moment ago needs neither the wallet nor a dialog
+    if (!lookupDone) {
+        const QString recent = lookupRecentAnswer(prompt, getppid());
+        if (!recent.isEmpty()) {
+            QTextStream(stdout) << recent;
+            return 0;
         }
-        QPointer<KPasswordDialog> kpd = new KPasswordDialog(nullptr, flag);
+    }
 
-        kpd->setPrompt(dialog);
-        kpd->setWindowTitle(i18n("Ksshaskpass"));
-        // We don't want to dump core when the password dialog is shown, because it could contain the entered password.
-        // KPasswordDialog::disableCoreDumps() seems to be gone in KDE 4 -- do it manually
-        struct rlimit rlim;
-        rlim.rlim_cur = rlim.rlim_max = 0;
-        setrlimit(RLIMIT_CORE, &rlim);
+    // Open the wallet (or the configured secret helper) to see if an item was previously stored. After the stored
+    // item has been rejected it is opened anyway, so the right one can replace it. Once that was done before we
+    // executed ourselves, the wallet is only opened again if the user keeps what they type.
+    const bool useWallet = !prompt.ignoreWallet || prompt.retry;
+    std::unique_ptr<SecretStore> wallet;
+    std::unique_ptr<WalletEntry> entry;
+    QString item;
+    if (lookupDone) {
+        entry = walletOpened ? std::make_unique<WalletEntry>(walletLocation(prompt.category), prompt.identifier)
+                             : std::make_unique<WalletEntry>(nullptr, prompt.identifier);
+    } else {
+        wallet = useWallet ? openSecretStore(walletLocation(prompt.category)) : nullptr;
+        entry = std::make_unique<WalletEntry>(wallet.get(), prompt.identifier, prompt.type == TypePassword);
+        item = lookupAnswer(prompt, *entry, getppid());
+    }
 
-        if (kpd->exec() == QDialog::Accepted) {
-            item = kpd->password();
-            // If "Enable Keep" is enabled, open/create a folder in KWallet and store the password.
-            if ((!identifier.isNull()) && wallet.get() && kpd->keepPassword()) {
-                if (!wallet->hasFolder(walletFolder)) {
-                    wallet->createFolder(walletFolder);
-                }
-                wallet->setFolder(walletFolder);
-                wallet->writePassword(identifier, item);
-            }
-        } else {
-            // dialog has been canceled
-            return 1;
+#if HAVE_GUI
+    if (coreOnly && item.isEmpty()) {
+        if (entry->isValid()) {
+            qputenv(walletOpenedVariable, "1");
         }
-        break;
+        entry.reset();
+        wallet.reset();
+        qputenv(lookupDoneVariable, "1");
+        const QByteArray program = QFile::encodeName(QCoreApplication::applicationFilePath());
+#if HAVE_PGO_INSTRUMENTATION && defined(__clang__)
+        __llvm_profile_write_file();
+#endif
+        execv(program.constData(), argv);
+        qCWarning(LOG_KSSHASKPASS) << "Unable to restart with dialogs:" << strerror(errno);
+        return 1;
     }
+#endif
+
+    if (!item.isEmpty()) {
+        QTextStream(stdout) << item;
+        return 0;
+    }
+
+    setupAboutData();
+
+    // Item could not be retrieved from wallet. Ask the user
+    if (!askAnswer(prompt, *entry, getppid(), item)) {
+        return 1;
     }
 
     QTextStream out(stdout);
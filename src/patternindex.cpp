@@ -0,0 +1,146 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "patternindex.h"
+
+// Splits "scheme://user@host:port" or "user@host" into the part before the host and the host itself.
+static void splitIdentifier(const QString &identifier, QString &prefix, QString &host)
+{
+    int hostStart = 0;
+    const int scheme = identifier.indexOf(QLatin1String("://"));
+    if (scheme >= 0) {
+        hostStart = scheme + 3;
+    }
+    const int at = identifier.lastIndexOf(QLatin1Char('@'));
+    if (at >= hostStart) {
+        hostStart = at + 1;
+    }
+
+    prefix = identifier.left(hostStart);
+    host = identifier.mid(hostStart);
+    const int port = host.lastIndexOf(QLatin1Char(':'));
+    if (port >= 0) {
+        host.truncate(port);
+    }
+    host = host.toLower();
+}
+
+static bool isHostName(const QString &host)
+{
+    return !host.isEmpty() && !host.contains(QLatin1Char('/')) && !host.contains(QLatin1Char(' '));
+}
+
+// What the part before the host says about an identifier or pattern.
+enum PrefixKind {
+    NoPrefix,
+    UrlPrefix, // scheme:// or scheme://user@
+    LoginPrefix, // user@
+    OtherPrefix,
+};
+
+static bool isPlainName(QStringView name)
+{
+    for (const QChar c : name) {
+        if (c.isSpace() || c == QLatin1Char(':') || c == QLatin1Char('/') || c == QLatin1Char('@')) {
+            return false;
+        }
+    }
+    return !name.isEmpty();
+}
+
+static PrefixKind prefixKind(const QString &prefix)
+{
+    if (prefix.isEmpty()) {
+        return NoPrefix;
+    }
+    const int scheme = prefix.indexOf(QLatin1String("://"));
+    if (scheme > 0) {
+        const QStringView user = QStringView(prefix).mid(scheme + 3);
+        if (isPlainName(QStringView(prefix).left(scheme)) && (user.isEmpty() || (user.endsWith(QLatin1Char('@')) && isPlainName(user.chopped(1))))) {
+            return UrlPrefix;
+        }
+        return OtherPrefix;
+    }
+    if (prefix.endsWith(QLatin1Char('@')) && isPlainName(QStringView(prefix).chopped(1))) {
+        return LoginPrefix;
+    }
+    return OtherPrefix;
+}
+
+// Whether a pattern with the given prefix answers for an identifier with the given prefix and kind.
+static bool prefixMatches(const QString &pattern, const QString &prefix, PrefixKind kind)
+{
+    if (kind == LoginPrefix) {
+        return pattern == prefix;
+    }
+    return pattern.isEmpty() || pattern == prefix || (pattern.endsWith(QLatin1String("://")) && prefix.startsWith(pattern));
+}
+
+bool PatternIndex::isPattern(const QString &key)
+{
+    QString prefix;
+    QString host;
+    splitIdentifier(key, prefix, host);
+    return host.startsWith(QLatin1String("*.")) && isHostName(host) && prefixKind(prefix) != OtherPrefix;
+}
+
+PatternIndex::PatternIndex(const QStringList &keys)
+{
+    for (const QString &key : keys) {
+        if (!isPattern(key)) {
+            continue;
+        }
+        QString prefix;
+        QString host;
+        splitIdentifier(key, prefix, host);
+
+        const QStringList labels = host.mid(2).split(QLatin1Char('.'));
+        Node *node = &m_root;
+        for (auto label = labels.crbegin(); label != labels.crend(); ++label) {
+            std::unique_ptr<Node> &child = node->children[*label];
+            if (!child) {
+                child = std::make_unique<Node>();
+            }
+            node = child.get();
+        }
+        node->patterns.push_back({prefix, key});
+        m_empty = false;
+    }
+}
+
+QString PatternIndex::match(const QString &identifier) const
+{
+    QString prefix;
+    QString host;
+    splitIdentifier(identifier, prefix, host);
+    const PrefixKind kind = prefixKind(prefix);
+    if (m_empty || !isHostName(host) || (kind != UrlPrefix && kind != LoginPrefix)) {
+        return QString();
+    }
+
+    const QStringList labels = host.split(QLatin1Char('.'));
+    const Pattern *best = nullptr;
+    const Node *node = &m_root;
+    // The wildcard stands for at least one label, so the leftmost label is never walked.
+    for (int i = labels.size() - 1; i > 0; --i) {
+        const auto child = node->children.find(labels.at(i));
+        if (child == node->children.end()) {
+            break;
+        }
+        node = child->second.get();
+
+        const Pattern *candidate = nullptr;
+        for (const Pattern &pattern : node->patterns) {
+            if (prefixMatches(pattern.prefix, prefix, kind) && (!candidate || pattern.prefix.size() > candidate->prefix.size())) {
+                candidate = &pattern;
+            }
+        }
+        if (candidate) {
+            best = candidate;
+        }
+    }
+
+    return best ? best->key : QString();
+}
@@ -0,0 +1,47 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+// Index over the wildcard entries of a wallet folder, such as "*.build.corp", "https://*.build.corp" or
+// "svc@*.build.corp", which hold one secret for a whole family of hosts. Host names are kept label by label from
+// the top level domain down, so finding the most specific pattern for a host is a single walk down the trie.
+//
+// URLs are only matched by patterns without a prefix or with a scheme:// or scheme://user@ prefix, and logins
+// (user@host) only by a pattern for the same user. Other identifiers never match.
+class PatternIndex
+{
+public:
+    // Builds the index from the keys of a folder, keys that aren't patterns are skipped.
+    explicit PatternIndex(const QStringList &keys);
+
+    // Whether key is a pattern the index takes.
+    static bool isPattern(const QString &key);
+
+    // Returns the key of the most specific pattern matching the canonical identifier, or a null string. A longer
+    // host suffix wins, then a longer scheme://user@ prefix.
+    QString match(const QString &identifier) const;
+
+private:
+    struct Pattern {
+        QString prefix;
+        QString key;
+    };
+
+    struct Node {
+        std::map<QString, std::unique_ptr<Node>> children;
+        std::vector<Pattern> patterns;
+    };
+
+    Node m_root;
+    bool m_empty = true;
+};
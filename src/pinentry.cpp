@@ -0,0 +1,244 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "pinentry.h"
+
+#include "dialogs.h"
+#include "secretstore.h"
+#include "walletentry.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <cstdio>
+#include <memory>
+#include <unistd.h>
+
+namespace
+{
+// libgpg-error codes with the pinentry error source
+const char cancelledError[] = "ERR 83886179 Operation cancelled <Pinentry>";
+const char notConfirmedError[] = "ERR 83886194 Not confirmed <Pinentry>";
+const char unknownCommandError[] = "ERR 536871187 Unknown IPC command <User defined source 1>";
+
+QString unescape(const QByteArray &argument)
+{
+    return QString::fromUtf8(QByteArray::fromPercentEncoding(argument));
+}
+
+// Data lines must not contain line breaks, and % starts an escape
+QByteArray escape(const QString &data)
+{
+    QByteArray escaped = data.toUtf8();
+    escaped.replace('%', "%25");
+    escaped.replace('\r', "%0D");
+    escaped.replace('\n', "%0A");
+    return escaped;
+}
+
+class Pinentry
+{
+public:
+    explicit Pinentry(const WalletLocation &location)
+        : m_location(location)
+    {
+    }
+
+    int run()
+    {
+        if (!m_in.open(stdin, QIODevice::ReadOnly) || !m_out.open(stdout, QIODevice::WriteOnly)) {
+            return 1;
+        }
+
+        reply("OK Pleased to meet you");
+        for (;;) {
+            QByteArray line = m_in.readLine();
+            if (line.isEmpty()) {
+                return 0;
+            }
+            while (line.endsWith('\n') || line.endsWith('\r')) {
+                line.chop(1);
+            }
+            if (line.isEmpty() || line.startsWith('#')) {
+                continue;
+            }
+
+            const int space = line.indexOf(' ');
+            const QByteArray command = (space < 0 ? line : line.left(space)).toUpper();
+            const QByteArray argument = space < 0 ? QByteArray() : line.mid(space + 1);
+            if (command == "BYE") {
+                reply("OK closing connection");
+                return 0;
+            }
+            handle(command, argument);
+        }
+    }
+
+private:
+    void reply(const QByteArray &line)
+    {
+        m_out.write(line + '\n');
+        m_out.flush();
+    }
+
+    void handle(const QByteArray &command, const QByteArray &argument)
+    {
+        if (command == "SETDESC") {
+            m_description = unescape(argument);
+        } else if (command == "SETPROMPT") {
+            m_prompt = unescape(argument);
+        } else if (command == "SETTITLE") {
+            m_title = unescape(argument);
+        } else if (command == "SETERROR") {
+            m_error = unescape(argument);
+        } else if (command == "SETKEYINFO") {
+            // "--clear" means there is nothing to cache the PIN under
+            m_keyInfo = argument == "--clear" ? QString() : unescape(argument);
+        } else if (command == "SETREPEAT") {
+            m_repeat = true;
+        } else if (command == "OPTION") {
+            if (argument == "allow-external-password-cache") {
+                m_allowExternalCache = true;
+            }
+        } else if (command == "GETINFO") {
+            if (argument == "flavor") {
+                reply("D kde");
+            } else if (argument == "version") {
+                reply("D " PROJECT_VERSION);
+            } else if (argument == "pid") {
+                reply("D " + QByteArray::number(getpid()));
+            }
+        } else if (command == "GETPIN") {
+            getPin();
+            return;
+        } else if (command == "CONFIRM") {
+            confirm(argument == "--one-button");
+            return;
+        } else if (command == "MESSAGE") {
+            confirm(true);
+            return;
+        } else if (command == "RESET") {
+            reset();
+        } else if (!command.startsWith("SET") && command != "NOP") {
+            reply(unknownCommandError);
+            return;
+        }
+        reply("OK");
+    }
+
+    void getPin()
+    {
+        // gpg-agent only lets a pinentry cache PINs if it sends allow-external-password-cache, and a new
+        // passphrase that has to be repeated is never looked up
+        const QString identifier = (m_allowExternalCache && !m_repeat && !m_keyInfo.isEmpty()) ? m_keyInfo : QString();
+        WalletEntry entry(identifier.isNull() ? nullptr : wallet(), identifier);
+
+        // An error means the previous PIN was wrong, which is only the stored one's fault if it was answered with
+        if (!m_error.isEmpty()) {
+            if (!identifier.isNull() && identifier == m_servedKeyInfo) {
+                entry.reject(m_servedDigest);
+            }
+            m_servedKeyInfo.clear();
+        } else {
+            const QString stored = entry.read(false);
+            if (!stored.isEmpty()) {
+                m_servedKeyInfo = identifier;
+                m_servedDigest = entry.digest(stored);
+                // Tells gpg-agent the PIN didn't come from the user, so a wrong one isn't counted as their attempt
+                reply("S PASSWORD_FROM_CACHE");
+                reply("D " + escape(stored));
+                reply("OK");
+                return;
+            }
+        }
+
+        PasswordQuestion question;
+        question.prompt = m_description.isEmpty() ? m_prompt : m_description;
+        question.title = m_title;
+        question.error = m_error;
+        question.offerKeep = entry.isValid();
+        m_error.clear();
+
+        QString pin;
+        bool keep = false;
+        if (!askPassword(question, pin, keep)) {
+            reply(cancelledError);
+            return;
+        }
+        if (keep) {
+            entry.write(pin);
+        }
+        reply("D " + escape(pin));
+        reply("OK");
+    }
+
+    void confirm(bool oneButton)
+    {
+        const QString text = m_description.isEmpty() ? m_prompt : m_description;
+        m_error.clear();
+        if (oneButton) {
+            showMessage(text, m_title);
+            reply("OK");
+        } else {
+            reply(askConfirmation(text, m_title) ? QByteArray("OK") : QByteArray(notConfirmedError));
+        }
+    }
+
+    void reset()
+    {
+        m_description.clear();
+        m_prompt.clear();
+        m_title.clear();
+        m_error.clear();
+        m_keyInfo.clear();
+        m_repeat = false;
+    }
+
+    // The wallet is opened once, on the first GETPIN that may use it
+    SecretStore *wallet()
+    {
+        if (!m_walletOpened) {
+            m_walletOpened = true;
+            m_wallet = openSecretStore(m_location);
+        }
+        return m_wallet.get();
+    }
+
+    QFile m_in;
+    QFile m_out;
+    const WalletLocation m_location;
+    std::unique_ptr<SecretStore> m_wallet;
+    bool m_walletOpened = false;
+
+    QString m_description;
+    QString m_prompt;
+    QString m_title;
+    QString m_error;
+    QString m_keyInfo;
+    // The key the last stored PIN was answered for, and its digest
+    QString m_servedKeyInfo;
+    QString m_servedDigest;
+    bool m_repeat = false;
+    bool m_allowExternalCache = false;
+};
+}
+
+bool isPinentryInvocation(int argc, char **argv)
+{
+    if (argc > 0 && QFileInfo(QFile::decodeName(argv[0])).fileName().startsWith(QLatin1String("pinentry"))) {
+        return true;
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--pinentry") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int runPinentry(const WalletLocation &location)
+{
+    return Pinentry(location).run();
+}
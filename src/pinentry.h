@@ -0,0 +1,16 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "secretstore.h"
+
+// Whether this process was started as a pinentry, with --pinentry or through a link named pinentry-*.
+bool isPinentryInvocation(int argc, char **argv);
+
+// Speaks the Assuan pinentry protocol on stdin and stdout, as gpg-agent expects from its pinentry-program, until
+// the other side says goodbye. Answers come from the wallet location if gpg-agent allows an external password
+// cache. Returns the exit code.
+int runPinentry(const WalletLocation &location);
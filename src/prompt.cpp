@@ -0,0 +1,438 @@
+/*
+ *   SPDX-FileCopyrightText: 2006 Hans van Leeuwen <hanz@hanz.nl>
+ *   SPDX-FileCopyrightText: 2008-2010 Armin Berres <armin@space-based.de>
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "prompt.h"
+
+#include "ksshaskpass_debug.h"
+#include "settings.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QUrl>
+
+namespace
+{
+// Real prompts are a line or two. Anything longer is not parsed at all.
+const int maxPromptLength = 4096;
+
+enum RuleFlag {
+    // The identifier must contain "@", ":" or " on "
+    NeedsAt = 0x1,
+    NeedsColon = 0x2,
+    NeedsOn = 0x4,
+    // The identifier may be missing, and must be if the rule says so
+    OptionalIdentifier = 0x8,
+    NoIdentifier = 0x10,
+    // " (will confirm each use)" at the end is not part of the identifier
+    StripWillConfirm = 0x20,
+    Retry = 0x40,
+    SessionOnly = 0x80,
+    // The steps of an expired password change, see PasswordChange
+    ChangeOld = 0x100,
+    ChangeNew = 0x200,
+    ChangeRetype = 0x400,
+};
+
+// The programs rules are written for, so only the rules for the calling program need to be tried
+enum Family {
+    FamilyOpenSsh = 0x1,
+    FamilyGit = 0x2,
+    FamilySudo = 0x4,
+    FamilyMercurial = 0x8,
+    // One-time password modules, asked for through ssh or sudo
+    FamilyPam = 0x10,
+};
+const int allFamilies = FamilyOpenSsh | FamilyGit | FamilySudo | FamilyMercurial | FamilyPam;
+
+struct Rule;
+
+// Finds the identifier in a prompt, or returns false if the prompt doesn't have the shape of the rule.
+using Matcher = bool (*)(const Rule &rule, QStringView prompt, QStringView &identifier);
+
+// Prompts are recognized by the literal text around the identifier, which takes time linear in the length of the
+// prompt whatever a remote server puts into host names or key comments.
+struct Rule {
+    enum Family family;
+    const char *prefix;
+    const char *suffix;
+    enum Type type;
+    enum Category category;
+    bool ignoreWallet;
+    int flags;
+    // Put in front of the identifier
+    const char *identifierPrefix;
+    // nullptr for "prefix identifier suffix" on one line
+    Matcher matcher;
+};
+
+// prefix, identifier, suffix, all on one line
+bool matchLine(const Rule &rule, QStringView prompt, QStringView &identifier)
+{
+    const QLatin1String prefix(rule.prefix);
+    const QLatin1String suffix(rule.suffix);
+    if (prompt.size() < prefix.size() + suffix.size() || !prompt.startsWith(prefix) || !prompt.endsWith(suffix) || prompt.contains(QLatin1Char('\n'))) {
+        return false;
+    }
+    identifier = prompt.mid(prefix.size(), prompt.size() - prefix.size() - suffix.size());
+    return true;
+}
+
+// Like matchLine, but the prefix may come anywhere in the last line
+bool matchLastLine(const Rule &rule, QStringView prompt, QStringView &identifier)
+{
+    const QStringView line = prompt.mid(prompt.lastIndexOf(QLatin1Char('\n')) + 1);
+    const QLatin1String prefix(rule.prefix);
+    const QLatin1String suffix(rule.suffix);
+    const qsizetype start = line.indexOf(prefix);
+    if (start < 0 || !line.endsWith(suffix) || line.size() - suffix.size() < start + prefix.size()) {
+        return false;
+    }
+    identifier = line.mid(start + prefix.size(), line.size() - suffix.size() - start - prefix.size());
+    return true;
+}
+
+// "<prefix><identifier>\nKey fingerprint <fingerprint>."
+bool matchKeyUse(const Rule &rule, QStringView prompt, QStringView &identifier)
+{
+    const QLatin1String prefix(rule.prefix);
+    const QLatin1String fingerprint("Key fingerprint ");
+    const qsizetype newline = prompt.indexOf(QLatin1Char('\n'));
+    if (!prompt.startsWith(prefix) || newline < prefix.size()) {
+        return false;
+    }
+    const QStringView rest = prompt.mid(newline + 1);
+    if (!rest.startsWith(fingerprint) || !rest.endsWith(QLatin1Char('.')) || rest.size() <= fingerprint.size() || rest.contains(QLatin1Char('\n'))) {
+        return false;
+    }
+    identifier = prompt.mid(prefix.size(), newline - prefix.size());
+    return true;
+}
+
+// "<prefix><identifier> (<comment><suffix>", the comment going back to the last " ("
+bool matchKeyComment(const Rule &rule, QStringView prompt, QStringView &identifier)
+{
+    QStringView line;
+    if (!matchLine(rule, prompt, line)) {
+        return false;
+    }
+    const qsizetype comment = line.lastIndexOf(QLatin1String(" ("));
+    if (comment < 0) {
+        return false;
+    }
+    identifier = line.left(comment);
+    return true;
+}
+
+// Whether askedBy is empty or "(<anything>) ", as OpenSSH 8.7 and later say who asks. identifier is set to what is
+// in the brackets if that is a user@host, and to an empty view otherwise.
+bool splitAskedBy(QStringView askedBy, QStringView &identifier)
+{
+    identifier = QStringView();
+    if (askedBy.isEmpty()) {
+        return true;
+    }
+    if (!askedBy.startsWith(QLatin1Char('(')) || !askedBy.endsWith(QLatin1String(") ")) || askedBy.size() < 3) {
+        return false;
+    }
+    const QStringView inside = askedBy.mid(1, askedBy.size() - 3);
+    if (inside.indexOf(QLatin1Char('@')) > 0) {
+        identifier = inside;
+    }
+    return true;
+}
+
+// "[(<user@host>) ]<suffix>"
+bool matchAskedBy(const Rule &rule, QStringView prompt, QStringView &identifier)
+{
+    QStringView askedBy;
+    return matchLine(rule, prompt, askedBy) && splitAskedBy(askedBy, identifier);
+}
+
+// "[(<user@host>) ]<prefix><anything><suffix>"
+bool matchAfterAskedBy(const Rule &rule, QStringView prompt, QStringView &identifier)
+{
+    const qsizetype start = prompt.indexOf(QLatin1String(rule.prefix));
+    QStringView user;
+    return start >= 0 && splitAskedBy(prompt.left(start), identifier) && matchLine(rule, prompt.mid(start), user);
+}
+
+// Try to understand what we're asked for by parsing the phrase. Unfortunately, sshaskpass interface does not
+// include any saner methods to pass the action or the name of the keyfile. Fortunately, openssh and git
+// has no i18n, so this should work for all languages as long as the string is unchanged. The first rule that
+// matches wins.
+const Rule rules[] = {
+    // openssh sshconnect2.c
+    // Case: password for authentication on remote ssh server
+    {FamilyOpenSsh, "", "'s password: ", TypePassword, CategoryHost, false, NeedsAt, "", nullptr},
+    {FamilyOpenSsh, "", "'s password (JPAKE): ", TypePassword, CategoryHost, false, NeedsAt, "", nullptr},
+
+    // openssh sshconnect2.c
+    // Case: password change request
+    {FamilyOpenSsh, "Enter ", "'s old password: ", TypePassword, CategoryHost, true, NeedsAt | ChangeOld, "", nullptr},
+    {FamilyOpenSsh, "Enter ", "'s new password: ", TypePassword, CategoryHost, true, NeedsAt | ChangeNew, "", nullptr},
+    {FamilyOpenSsh, "Retype ", "'s old password: ", TypePassword, CategoryHost, true, NeedsAt, "", nullptr},
+    {FamilyOpenSsh, "Retype ", "'s new password: ", TypePassword, CategoryHost, true, NeedsAt | ChangeRetype, "", nullptr},
+
+    // openssh sshconnect2.c and sshconnect1.c
+    // Case: asking for passphrase for a certain keyfile
+    {FamilyOpenSsh, "Enter passphrase for key '", "': ", TypePassword, CategoryKey, false, 0, "", nullptr},
+    {FamilyOpenSsh, "Enter passphrase for RSA key '", "': ", TypePassword, CategoryKey, false, 0, "", nullptr},
+
+    // openssh ssh-add.c
+    // Case: asking for passphrase for a certain keyfile for the first time => we should try a password from the wallet
+    {FamilyOpenSsh, "Enter passphrase for ", ": ", TypePassword, CategoryKey, false, StripWillConfirm, "", nullptr},
+
+    // openssh ssh-add.c
+    // Case: re-asking for passphrase for a certain keyfile => probably we've tried a password from the wallet, no point
+    // in trying it again, but the right one should replace it
+    {FamilyOpenSsh, "Bad passphrase, try again for ", ": ", TypePassword, CategoryKey, true, StripWillConfirm | Retry, "", nullptr},
+
+    // openssh ssh-pkcs11.c
+    // Case: asking for PIN for some token label
+    {FamilyOpenSsh, "Enter PIN for '", "': ", TypePassword, CategoryKey, false, 0, "", matchLastLine},
+
+    // openssh mux.c
+    {FamilyOpenSsh, "Allow shared connection to ", "? ", TypeConfirm, CategoryOther, true, 0, "", nullptr},
+    {FamilyOpenSsh, "Terminate shared connection to ", "? ", TypeConfirm, CategoryOther, true, 0, "", nullptr},
+    {FamilyOpenSsh, "Open ", "", TypeConfirm, CategoryOther, true, NeedsOn | OptionalIdentifier, "", nullptr},
+    {FamilyOpenSsh, "Allow forward to ", "? ", TypeConfirm, CategoryOther, true, NeedsColon, "", nullptr},
+    {FamilyOpenSsh, "Disable further multiplexing on shared connection to ", " ", TypeConfirm, CategoryOther, true, 0, "", nullptr},
+
+    // openssh ssh-agent.c
+    {FamilyOpenSsh, "Allow use of key ", "", TypeConfirm, CategoryOther, true, 0, "", matchKeyUse},
+
+    // openssh sshconnect.c
+    {FamilyOpenSsh, "Add key ", ") to agent?", TypeConfirm, CategoryOther, true, 0, "", matchKeyComment},
+
+    // git imap-send.c
+    // Case: asking for password by git imap-send
+    {FamilyGit, "Password (", "): ", TypePassword, CategoryGit, false, NeedsAt, "", nullptr},
+
+    // git credential.c
+    // Case: asking for username or password by git without specifying any other information
+    {FamilyGit, "Username: ", "", TypeClearText, CategoryGit, true, NoIdentifier, "", nullptr},
+    {FamilyGit, "Password: ", "", TypePassword, CategoryGit, true, NoIdentifier, "", nullptr},
+
+    // git credential.c
+    // Case: asking for username or password by git for some identifier
+    {FamilyGit, "Username for '", "': ", TypeClearText, CategoryGit, false, 0, "", nullptr},
+    {FamilyGit, "Password for '", "': ", TypePassword, CategoryGit, false, 0, "", nullptr},
+
+    // Case: username or password extraction from git-lfs
+    {FamilyGit, "Username for \"", "\"", TypeClearText, CategoryGit, false, 0, "", nullptr},
+    {FamilyGit, "Password for \"", "\"", TypePassword, CategoryGit, false, 0, "", nullptr},
+
+    // sudo -A with SUDO_ASKPASS, default SUDO_PROMPT
+    // Case: login password of the user for sudo => never goes to the wallet, but may be remembered for a while
+    {FamilySudo, "[sudo] password for ", ": ", TypePassword, CategoryOther, true, SessionOnly, "sudo:", nullptr},
+
+    // OpenSSH keyboard-interactive with pam_google_authenticator, prefixed with "(user@host) " since OpenSSH 8.7
+    // Case: time-based one-time password => computed from a seed stored in the wallet, the code itself is never stored.
+    // Without the user@host a code for one server could be sent to another, so it is only asked for.
+    {FamilyPam, "", "Verification code: ", TypeOtp, CategoryOtp, false, OptionalIdentifier, "otp:", matchAskedBy},
+
+    // pam_oath
+    // Case: time-based one-time password for a user => as above
+    {FamilyPam, "One-time password (OATH) for `", "': ", TypeOtp, CategoryOtp, false, OptionalIdentifier, "otp:", matchAfterAskedBy},
+
+    // Case: password extraction from mercurial, see bug 380085
+    {FamilyMercurial, "", "'s password: ", TypePassword, CategoryOther, false, 0, "", nullptr},
+};
+
+// The rule families worth trying for the program with process id caller, as told by its name. All of them if the
+// caller is unknown, or if that is turned off.
+int callerFamilies(qint64 caller)
+{
+    if (caller <= 0 || !settings().readEntry("CallerRules", false)) {
+        return allFamilies;
+    }
+    QFile comm(QStringLiteral("/proc/%1/comm").arg(caller));
+    if (!comm.open(QIODevice::ReadOnly)) {
+        return allFamilies;
+    }
+    const QByteArray name = comm.readLine().trimmed();
+    if (name == "ssh" || name.startsWith("ssh-") || name == "scp" || name == "sftp") {
+        return FamilyOpenSsh | FamilyPam;
+    }
+    // Long names like git-remote-https are cut to 15 characters
+    if (name == "git" || name.startsWith("git-")) {
+        return FamilyGit;
+    }
+    if (name == "sudo") {
+        return FamilySudo | FamilyPam;
+    }
+    if (name == "hg" || name == "chg") {
+        return FamilyMercurial;
+    }
+    return allFamilies;
+}
+
+bool matches(const Rule &rule, QStringView prompt, QString &identifier)
+{
+    QStringView found;
+    if (!(rule.matcher ? rule.matcher(rule, prompt, found) : matchLine(rule, prompt, found))) {
+        return false;
+    }
+
+    if ((rule.flags & NoIdentifier) && !found.isEmpty()) {
+        return false;
+    }
+    if ((rule.flags & (OptionalIdentifier | NoIdentifier)) && found.isEmpty()) {
+        identifier = QString();
+        return true;
+    }
+    if (((rule.flags & NeedsAt) && !found.contains(QLatin1Char('@'))) || ((rule.flags & NeedsColon) && !found.contains(QLatin1Char(':')))
+        || ((rule.flags & NeedsOn) && !found.contains(QLatin1String(" on ")))) {
+        return false;
+    }
+    if (rule.flags & StripWillConfirm) {
+        const QLatin1String willConfirm(" (will confirm each use)");
+        if (found.endsWith(willConfirm)) {
+            found.chop(willConfirm.size());
+        }
+    }
+    identifier = QLatin1String(rule.identifierPrefix) + found.toString();
+    return true;
+}
+}
+
+// An identifier for a prompt no rule knows, if enabled: the prompt without the parts that change from call to call,
+// like times and counters, which are matched by the expressions in [Unrecognized][Strip].
+static QString unrecognizedIdentifier(const QString &prompt)
+{
+    const KConfigGroup group = settings(QStringLiteral("Unrecognized"));
+    if (!group.readEntry("Enabled", false)) {
+        return QString();
+    }
+
+    QStringList patterns = group.group(QStringLiteral("Strip")).entryMap().values();
+    if (!group.hasGroup(QStringLiteral("Strip"))) {
+        // Dates, times of day and numbers in brackets, like attempt counters
+        patterns = {QStringLiteral("[0-9]{4}-[0-9]{2}-[0-9]{2}"), QStringLiteral("[0-9]{1,2}:[0-9]{2}(:[0-9]{2})?"), QStringLiteral("[(\\[][0-9/ ]+[)\\]]")};
+    }
+    QString normalized = prompt;
+    for (const QString &pattern : std::as_const(patterns)) {
+        const QRegularExpression expression(pattern);
+        if (!expression.isValid()) {
+            qCWarning(LOG_KSSHASKPASS) << "Ignoring invalid pattern" << pattern << expression.errorString();
+            continue;
+        }
+        normalized.remove(expression);
+    }
+    normalized = normalized.simplified();
+    return normalized.isEmpty() ? QString() : QLatin1String("prompt:") + normalized;
+}
+
+ParsedPrompt::ParsedPrompt(const QString &text, qint64 caller)
+    : text(text)
+{
+    if (text.size() > maxPromptLength) {
+        qCWarning(LOG_KSSHASKPASS) << "Not parsing a phrase of" << text.size() << "characters";
+        return;
+    }
+
+    // A final newline, which scripts may well add, is ignored as "$" in the regular expressions used before did
+    QStringView parsed(text);
+    if (parsed.endsWith(QLatin1Char('\n'))) {
+        parsed.chop(1);
+    }
+
+    const int families = callerFamilies(caller);
+    for (const Rule &rule : rules) {
+        if ((rule.family & families) && matches(rule, parsed, identifier)) {
+            type = rule.type;
+            category = rule.category;
+            ignoreWallet = rule.ignoreWallet;
+            retry = rule.flags & Retry;
+            sessionOnly = rule.flags & SessionOnly;
+            if (rule.flags & ChangeOld) {
+                passwordChange = PasswordChangeOld;
+            } else if (rule.flags & ChangeNew) {
+                passwordChange = PasswordChangeNew;
+            } else if (rule.flags & ChangeRetype) {
+                passwordChange = PasswordChangeRetype;
+            }
+            return;
+        }
+    }
+
+    // Nothing matched; either it was called by some sort of a script with a custom prompt (i.e. not ssh-add), or
+    // strings we're looking for were broken. Issue a warning and continue without identifier, unless the prompt
+    // itself may serve as one.
+    qCWarning(LOG_KSSHASKPASS) << "Unable to parse phrase" << text;
+    identifier = unrecognizedIdentifier(text);
+    guessedIdentifier = !identifier.isNull();
+}
+
+QString categoryName(enum Category category)
+{
+    switch (category) {
+    case CategoryKey:
+        return QStringLiteral("key");
+    case CategoryHost:
+        return QStringLiteral("host");
+    case CategoryGit:
+        return QStringLiteral("git");
+    case CategoryOtp:
+        return QStringLiteral("otp");
+    case CategoryGpg:
+        return QStringLiteral("gpg");
+    case CategoryOther:
+        break;
+    }
+    return QStringLiteral("other");
+}
+
+QString canonicalIdentifier(const QString &identifier)
+{
+    if (identifier.isEmpty()) {
+        return identifier;
+    }
+
+    // git and git-lfs: https://user@host/path.git and https://host/ share their credentials per host
+    if (identifier.contains(QLatin1String("://"))) {
+        const QUrl url(identifier);
+        if (!url.isValid() || url.host().isEmpty()) {
+            return identifier;
+        }
+        QString canonical = url.scheme() + QLatin1String("://");
+        if (!url.userName().isEmpty()) {
+            canonical += url.userName() + QLatin1Char('@');
+        }
+        canonical += url.host();
+        const int port = url.port();
+        const bool defaultPort = (port == 443 && url.scheme() == QLatin1String("https")) || (port == 80 && url.scheme() == QLatin1String("http"))
+            || (port == 22 && url.scheme() == QLatin1String("ssh"));
+        if (port != -1 && !defaultPort) {
+            canonical += QLatin1Char(':') + QString::number(port);
+        }
+        return canonical;
+    }
+
+    // Key files: ~/.ssh/id_ed25519, /home/u/.ssh/id_ed25519 and symlinks to it, or a path relative to the
+    // directory ssh-add was started in, which we inherit.
+    QString path = identifier;
+    if (path.startsWith(QLatin1String("~/"))) {
+        path = QDir::homePath() + path.mid(1);
+    }
+    const QFileInfo keyFile(path);
+    if (keyFile.isFile()) {
+        return keyFile.canonicalFilePath();
+    }
+    if (path.startsWith(QLatin1Char('/'))) {
+        return QDir::cleanPath(path);
+    }
+
+    // openssh and git imap-send: user@Host, host names are case insensitive
+    const int at = identifier.lastIndexOf(QLatin1Char('@'));
+    if (at > 0 && !identifier.contains(QLatin1Char(' '))) {
+        return identifier.left(at + 1) + identifier.mid(at + 1).toLower();
+    }
+
+    return identifier;
+}
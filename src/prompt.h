@@ -0,0 +1,64 @@
+/*
+ *   SPDX-FileCopyrightText: 2006 Hans van Leeuwen <hanz@hanz.nl>
+ *   SPDX-FileCopyrightText: 2008-2010 Armin Berres <armin@space-based.de>
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QString>
+
+enum Type {
+    TypePassword,
+    TypeClearText,
+    TypeConfirm,
+    TypeOtp,
+};
+
+// What kind of secret a prompt asks for, which decides the wallet and folder it is kept in.
+enum Category {
+    CategoryOther,
+    CategoryKey,
+    CategoryHost,
+    CategoryGit,
+    CategoryOtp,
+    // PINs and passphrases gpg-agent asks for through the pinentry front end
+    CategoryGpg,
+};
+
+// The prompts OpenSSH shows one after the other when a password has expired.
+enum PasswordChange {
+    PasswordChangeNone,
+    PasswordChangeOld,
+    PasswordChangeNew,
+    PasswordChangeRetype,
+};
+
+// The name of category in the settings.
+QString categoryName(enum Category category);
+
+// A prompt of the calling program, and what it asks for for which key, host or account. retry is set if the
+// prompt says that the previous answer for identifier was wrong, sessionOnly if the answer may be remembered for a
+// few minutes but must never be stored in the wallet. guessedIdentifier is set if no rule knew the prompt and the
+// identifier was made from its text.
+struct ParsedPrompt {
+    ParsedPrompt() = default;
+    // caller is the process id of the program asking, if known. If enabled in the settings, only the rules for
+    // that program are tried.
+    explicit ParsedPrompt(const QString &text, qint64 caller = 0);
+
+    QString text;
+    QString identifier;
+    enum Type type = TypePassword;
+    enum Category category = CategoryOther;
+    enum PasswordChange passwordChange = PasswordChangeNone;
+    bool ignoreWallet = false;
+    bool retry = false;
+    bool sessionOnly = false;
+    bool guessedIdentifier = false;
+};
+
+// Maps the different spellings of one key file or host to the key its secrets are stored under: key files by their
+// canonical path, URLs by scheme://user@host[:port] and user@host by the lower case host. Anything else is returned
+// unchanged.
+QString canonicalIdentifier(const QString &identifier);
@@ -0,0 +1,112 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "promptgate.h"
+
+#include "ksshaskpass_debug.h"
+#include "sessioncache.h"
+#include "settings.h"
+
+#include <QCryptographicHash>
+#include <QLockFile>
+#include <QStandardPaths>
+#include <QThread>
+
+// Prompts without an identifier, like git's "Password: ", look the same for different programs and hosts, one-time
+// passwords are used up once answered, and answers that must not go to the wallet must not go to anyone else either.
+static bool isShareable(const ParsedPrompt &prompt)
+{
+    if (prompt.type == TypeConfirm) {
+        return true;
+    }
+    return !prompt.identifier.isEmpty() && !prompt.guessedIdentifier && prompt.type != TypeOtp && !prompt.ignoreWallet && !prompt.sessionOnly;
+}
+
+PromptGate::PromptGate(const ParsedPrompt &prompt, qint64 caller)
+    : m_name(QLatin1String("decision:") + QString::fromLatin1(QCryptographicHash::hash(prompt.text.toUtf8(), QCryptographicHash::Sha256).toHex()))
+    , m_caller(QByteArray::number(caller))
+{
+    const KConfigGroup group = settings(QStringLiteral("Dialogs"));
+    m_window = isShareable(prompt) ? group.readEntry("RepeatWindow", 10) : 0;
+    m_shareAnswers = prompt.type == TypeConfirm || group.readEntry("SharePasswords", false);
+    m_maxOpen = group.readEntry("MaxOpen", 1);
+}
+
+PromptGate::~PromptGate() = default;
+
+// Decisions are kept as "<caller>\n0" for a canceled prompt and "<caller>\n1<answer>" for an answered one
+bool PromptGate::takeDecision(bool &answered, QString &answer) const
+{
+    if (m_window <= 0) {
+        return false;
+    }
+    const QByteArray decision = SessionCache::lookup(m_name);
+    const int newline = decision.indexOf('\n');
+    if (newline < 0 || newline + 1 >= decision.size()) {
+        return false;
+    }
+    answered = decision.at(newline + 1) == '1';
+    // The same program asking again after an answer means the answer was wrong
+    if (answered && decision.left(newline) == m_caller) {
+        return false;
+    }
+    answer = answered ? QString::fromUtf8(decision.mid(newline + 2)) : QString();
+    return true;
+}
+
+PromptGate::Turn PromptGate::tryTurn(bool &answered, QString &answer)
+{
+    if (takeDecision(answered, answer)) {
+        qCDebug(LOG_KSSHASKPASS) << "Prompt was just decided, not asking again";
+        return Decided;
+    }
+    const QString runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (m_maxOpen <= 0 || runtimeDir.isEmpty()) {
+        return Ask;
+    }
+    for (int i = 0; i < m_maxOpen; ++i) {
+        auto slot = std::make_unique<QLockFile>(runtimeDir + QStringLiteral("/ksshaskpass-dialog-%1.lock").arg(i));
+        // A dialog may be open for a long time, the slot is only taken over if its process is gone
+        slot->setStaleLockTime(0);
+        if (slot->tryLock(0)) {
+            m_slot = std::move(slot);
+            return Ask;
+        }
+    }
+    return Wait;
+}
+
+bool PromptGate::waitForTurn(bool &answered, QString &answer)
+{
+    bool waiting = false;
+    for (;;) {
+        switch (tryTurn(answered, answer)) {
+        case Decided:
+            return false;
+        case Ask:
+            return true;
+        case Wait:
+            break;
+        }
+        if (!waiting) {
+            waiting = true;
+            qCDebug(LOG_KSSHASKPASS) << "Waiting for one of" << m_maxOpen << "dialogs to close";
+        }
+        QThread::msleep(pollInterval);
+    }
+}
+
+void PromptGate::decide(bool answered, const QString &answer)
+{
+    if (m_window > 0 && (m_shareAnswers || !answered)) {
+        QByteArray decision = m_caller + '\n';
+        decision += answered ? '1' : '0';
+        if (answered) {
+            decision += answer.toUtf8();
+        }
+        SessionCache::store(m_name, decision, m_window);
+    }
+    m_slot.reset();
+}
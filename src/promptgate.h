@@ -0,0 +1,57 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "prompt.h"
+
+#include <QString>
+
+#include <memory>
+
+class QLockFile;
+
+// Keeps a program that asks in a loop from flooding the desktop with dialogs. Only a few dialogs are open at a
+// time, across all ksshaskpass processes of the user, and the others wait for a free slot. The decision on a
+// confirmation, or on a prompt naming a host or key whose answer could be kept in the wallet, is shared for a few
+// seconds with everyone asking the same, so waiting and repeated prompts are answered without a dialog of their
+// own. Passwords typed into the latter are only shared if the settings allow it, cancellations always are.
+class PromptGate
+{
+public:
+    // How often, in milliseconds, a waiting prompt looks for a free slot or a decision
+    static constexpr int pollInterval = 250;
+
+    enum Turn {
+        Decided, // the same prompt was decided meanwhile or a moment ago
+        Ask, // a dialog may be shown now
+        Wait, // all dialog slots are taken
+    };
+
+    // caller is the process id of the program asking.
+    PromptGate(const ParsedPrompt &prompt, qint64 caller);
+    ~PromptGate();
+
+    // Looks once whether a dialog may be shown, without waiting. With Decided, answered and answer are set to the
+    // decision.
+    Turn tryTurn(bool &answered, QString &answer);
+
+    // Waits until a dialog may be shown and returns true. Returns false instead if the same prompt was decided
+    // meanwhile or a moment ago, with answered and answer set to that decision.
+    bool waitForTurn(bool &answered, QString &answer);
+
+    // Shares the decision on the prompt and frees the dialog slot.
+    void decide(bool answered, const QString &answer);
+
+private:
+    bool takeDecision(bool &answered, QString &answer) const;
+
+    const QString m_name;
+    const QByteArray m_caller;
+    int m_window = 0;
+    bool m_shareAnswers = false;
+    int m_maxOpen = 0;
+    std::unique_ptr<QLockFile> m_slot;
+};
@@ -0,0 +1,280 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "resulttable.h"
+
+#include "ksshaskpass_debug.h"
+#include "settings.h"
+
+#ifdef Q_OS_LINUX
+#include <QCryptographicHash>
+#include <QDateTime>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+const quint32 tableVersion = 1;
+const int slotCount = 64;
+// How many slots after the one a key hashes to may hold it
+const int probeLength = 8;
+const int keySize = 32;
+const int maxValueSize = 256;
+
+struct Slot {
+    // Odd while a writer changes the slot. Readers retry if it changed while they read.
+    std::atomic<quint32> generation;
+    quint32 size;
+    // Milliseconds since the epoch, 0 for an empty slot
+    qint64 expires;
+    char key[keySize];
+    char value[maxValueSize];
+};
+
+// All zeros is an empty table, which is what a new shared memory object holds
+struct Table {
+    std::atomic<quint32> version;
+    Slot slots[slotCount];
+};
+
+static_assert(std::atomic<quint32>::is_always_lock_free, "the table is shared between processes");
+
+QByteArray objectName()
+{
+    return QByteArrayLiteral("/ksshaskpass-") + QByteArray::number(getuid());
+}
+
+Table *mapTable(bool create)
+{
+    const int fd = shm_open(objectName().constData(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return nullptr;
+    }
+    // Only ever use a table that no one else can read, and that has the expected size
+    struct stat info;
+    const bool usable = fstat(fd, &info) == 0 && info.st_uid == getuid() && (info.st_mode & 077) == 0
+        && (info.st_size == sizeof(Table) || (info.st_size == 0 && ftruncate(fd, sizeof(Table)) == 0));
+    void *memory = usable ? mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED) {
+        qCWarning(LOG_KSSHASKPASS) << "Unable to use the table of recent answers";
+        return nullptr;
+    }
+    if (mlock(memory, sizeof(Table)) != 0) {
+        qCDebug(LOG_KSSHASKPASS) << "Unable to lock the table of recent answers in memory:" << strerror(errno);
+    }
+
+    Table *table = static_cast<Table *>(memory);
+    quint32 version = 0;
+    if (!table->version.compare_exchange_strong(version, tableVersion) && version != tableVersion) {
+        qCWarning(LOG_KSSHASKPASS) << "The table of recent answers has an unknown layout" << version;
+        munmap(memory, sizeof(Table));
+        return nullptr;
+    }
+    return table;
+}
+
+Table *mapped = nullptr;
+bool triedMapping = false;
+
+Table *table(bool create)
+{
+    if (!mapped && (create || !triedMapping)) {
+        triedMapping = true;
+        mapped = mapTable(create);
+    }
+    return mapped;
+}
+
+QByteArray keyDigest(const QString &key)
+{
+    return QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha256);
+}
+
+Slot &slotAt(Table &table, const QByteArray &digest, int probe)
+{
+    const quint32 hash = quint32(uchar(digest.at(0))) | quint32(uchar(digest.at(1))) << 8 | quint32(uchar(digest.at(2))) << 16;
+    return table.slots[(hash + probe) % slotCount];
+}
+
+// Returns whether the slot holds key and hasn't expired, with its value in value.
+bool readSlot(const Slot &slot, const QByteArray &digest, qint64 now, QByteArray &value)
+{
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        const quint32 generation = slot.generation.load(std::memory_order_acquire);
+        if (generation & 1) {
+            continue;
+        }
+        const quint32 size = slot.size;
+        const bool matches = slot.expires > now && size <= quint32(maxValueSize) && memcmp(slot.key, digest.constData(), keySize) == 0;
+        if (matches) {
+            value = QByteArray(slot.value, size);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.generation.load(std::memory_order_relaxed) == generation) {
+            return matches;
+        }
+    }
+    return false;
+}
+
+// Replaces what the slot holds, unless another writer is busy with it. An empty digest clears the slot.
+bool writeSlot(Slot &slot, const QByteArray &digest, const QByteArray &value, qint64 expires)
+{
+    quint32 generation = slot.generation.load(std::memory_order_relaxed);
+    if ((generation & 1) || !slot.generation.compare_exchange_strong(generation, generation + 1, std::memory_order_acquire)) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    memset(slot.key, 0, keySize);
+    memcpy(slot.key, digest.constData(), digest.size());
+    memset(slot.value, 0, maxValueSize);
+    memcpy(slot.value, value.constData(), value.size());
+    slot.size = quint32(value.size());
+    slot.expires = expires;
+    slot.generation.store(generation + 2, std::memory_order_release);
+    return true;
+}
+
+// Clears every slot that expired. The table is only locked in memory while some process has it mapped, between
+// prompts it may be swapped out like any file in /dev/shm, so answers must not stay around until their slot is
+// needed again. Returns whether the table holds no answers any more.
+bool sweep(Table &table, qint64 now)
+{
+    bool empty = true;
+    for (Slot &slot : table.slots) {
+        if (slot.expires != 0 && slot.expires <= now) {
+            writeSlot(slot, QByteArray(), QByteArray(), 0);
+        }
+        if (slot.expires != 0 || (slot.generation.load(std::memory_order_relaxed) & 1)) {
+            empty = false;
+        }
+    }
+    return empty;
+}
+
+// Removes the shared memory object once nothing is left in it, and returns whether it did. The next answer to be
+// stored creates a new table. Another process that still has the old one mapped may store an answer there that
+// no one finds, which only costs a lookup.
+bool unlinkIfEmpty(qint64 now)
+{
+    if (!mapped || !sweep(*mapped, now)) {
+        return false;
+    }
+    shm_unlink(objectName().constData());
+    munmap(mapped, sizeof(Table));
+    mapped = nullptr;
+    return true;
+}
+}
+#endif
+
+bool ResultTable::isEnabled()
+{
+    return settings(QStringLiteral("RecentAnswers")).readEntry("Enabled", false);
+}
+
+#ifdef Q_OS_LINUX
+bool ResultTable::exists()
+{
+    const int fd = shm_open(objectName().constData(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+    return true;
+}
+
+QString ResultTable::lookup(const QString &key)
+{
+    Table *shared = isEnabled() ? table(false) : nullptr;
+    if (!shared) {
+        return QString();
+    }
+    const QByteArray digest = keyDigest(key);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (unlinkIfEmpty(now)) {
+        return QString();
+    }
+    for (int probe = 0; probe < probeLength; ++probe) {
+        QByteArray value;
+        if (readSlot(slotAt(*shared, digest, probe), digest, now, value)) {
+            return QString::fromUtf8(value);
+        }
+    }
+    return QString();
+}
+
+void ResultTable::store(const QString &key, const QString &answer)
+{
+    const QByteArray value = answer.toUtf8();
+    Table *shared = (value.size() <= maxValueSize && isEnabled()) ? table(true) : nullptr;
+    if (!shared) {
+        return;
+    }
+    const QByteArray digest = keyDigest(key);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    sweep(*shared, now);
+
+    // The slot already holding key, else a free one, else the one that expires first
+    Slot *target = nullptr;
+    for (int probe = 0; probe < probeLength; ++probe) {
+        Slot &slot = slotAt(*shared, digest, probe);
+        if (memcmp(slot.key, digest.constData(), keySize) == 0) {
+            target = &slot;
+            break;
+        }
+        if (!target || (target->expires > now && slot.expires < target->expires)) {
+            target = &slot;
+        }
+    }
+    const int timeout = settings(QStringLiteral("RecentAnswers")).readEntry("Timeout", 30);
+    writeSlot(*target, digest, value, now + timeout * 1000);
+}
+
+void ResultTable::remove(const QString &key)
+{
+    Table *shared = table(false);
+    if (!shared) {
+        return;
+    }
+    const QByteArray digest = keyDigest(key);
+    for (int probe = 0; probe < probeLength; ++probe) {
+        Slot &slot = slotAt(*shared, digest, probe);
+        if (memcmp(slot.key, digest.constData(), keySize) == 0) {
+            writeSlot(slot, QByteArray(), QByteArray(), 0);
+        }
+    }
+    unlinkIfEmpty(QDateTime::currentMSecsSinceEpoch());
+}
+#else
+bool ResultTable::exists()
+{
+    return false;
+}
+
+QString ResultTable::lookup(const QString &key)
+{
+    Q_UNUSED(key)
+    return QString();
+}
+
+void ResultTable::store(const QString &key, const QString &answer)
+{
+    Q_UNUSED(key)
+    Q_UNUSED(answer)
+}
+
+void ResultTable::remove(const QString &key)
+{
+    Q_UNUSED(key)
+}
+#endif
@@ -0,0 +1,30 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QString>
+
+// Answers given a moment ago, shared by all ksshaskpass processes of the user through a small table in shared
+// memory, so a process asked the same right after another one answers without opening the wallet or a dialog.
+// Slots are found by a hash of the key and read without locks; each carries a generation counter that is odd
+// while a writer changes it, and an expiry time. The table is locked in memory while a process has it mapped,
+// expired answers are wiped whenever it is used, and it is removed once empty. Off unless enabled in the settings,
+// and only available on Linux.
+namespace ResultTable
+{
+bool isEnabled();
+
+// Whether some process created the table, which is cheap to check before the settings are read.
+bool exists();
+
+// Returns the answer kept under key, or a null string if there is none or it expired.
+QString lookup(const QString &key);
+
+// Keeps answer under key for the configured time. Long answers are not kept.
+void store(const QString &key, const QString &answer);
+
+void remove(const QString &key);
+}
@@ -0,0 +1,258 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "secretstore.h"
+
+#include "config-ksshaskpass.h"
+#if HAVE_KWALLET
+#include "kwalletstore.h"
+#endif
+
+#include "ksshaskpass_debug.h"
+#include "settings.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+
+namespace
+{
+class HelperSecretStore : public SecretStore
+{
+public:
+    HelperSecretStore(const QString &command, const WalletLocation &location)
+        : SecretStore(location)
+        , m_folder(location.folder)
+    {
+        m_arguments = QProcess::splitCommand(command);
+        if (!m_arguments.isEmpty()) {
+            m_program = m_arguments.takeFirst();
+        }
+    }
+
+    QString readPassword(const QString &key) override
+    {
+        QByteArray output;
+        if (!run({QStringLiteral("get"), m_folder, key}, QByteArray(), &output)) {
+            return QString();
+        }
+        if (output.endsWith('\n')) {
+            output.chop(1);
+        }
+        return QString::fromUtf8(output);
+    }
+
+    bool writePassword(const QString &key, const QString &value) override
+    {
+        if (!run({QStringLiteral("store"), m_folder, key}, value.toUtf8(), nullptr)) {
+            return false;
+        }
+        updatePatterns(QString(), key);
+        return true;
+    }
+
+    bool renameEntry(const QString &oldKey, const QString &newKey) override
+    {
+        const QString value = readPassword(oldKey);
+        if (value.isNull() || !writePassword(newKey, value) || !run({QStringLiteral("erase"), m_folder, oldKey}, QByteArray(), nullptr)) {
+            return false;
+        }
+        updatePatterns(oldKey, QString());
+        return true;
+    }
+
+    bool removeEntry(const QString &key) override
+    {
+        if (!run({QStringLiteral("erase"), m_folder, key}, QByteArray(), nullptr)) {
+            return false;
+        }
+        updatePatterns(key, QString());
+        return true;
+    }
+
+    QStringList entryList() override
+    {
+        QByteArray output;
+        if (!run({QStringLiteral("list"), m_folder}, QByteArray(), &output)) {
+            return QStringList();
+        }
+        return QString::fromUtf8(output).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    }
+
+    QMap<QString, QString> readMap(const QString &key) override
+    {
+        QMap<QString, QString> map;
+        const QJsonObject object = QJsonDocument::fromJson(readPassword(key).toUtf8()).object();
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+            map.insert(it.key(), it.value().toString());
+        }
+        return map;
+    }
+
+    bool writeMap(const QString &key, const QMap<QString, QString> &value) override
+    {
+        QJsonObject object;
+        for (auto it = value.constBegin(); it != value.constEnd(); ++it) {
+            object.insert(it.key(), it.value());
+        }
+        return writePassword(key, QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact)));
+    }
+
+private:
+    bool run(const QStringList &arguments, const QByteArray &input, QByteArray *output)
+    {
+        if (m_program.isEmpty()) {
+            return false;
+        }
+
+        QProcess process;
+        process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process.start(m_program, m_arguments + arguments);
+        if (!process.waitForStarted()) {
+            qCWarning(LOG_KSSHASKPASS) << "Unable to start secret helper" << m_program << process.errorString();
+            return false;
+        }
+        process.write(input);
+        process.closeWriteChannel();
+        if (!process.waitForFinished()) {
+            qCWarning(LOG_KSSHASKPASS) << "Secret helper" << m_program << "did not finish";
+            process.kill();
+            return false;
+        }
+        if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+            return false;
+        }
+        if (output) {
+            *output = process.readAllStandardOutput();
+        }
+        return true;
+    }
+
+    QString m_program;
+    QStringList m_arguments;
+    const QString m_folder;
+};
+}
+
+SecretStore::SecretStore(const WalletLocation &location)
+    : m_location(location)
+{
+}
+
+const WalletLocation &SecretStore::location() const
+{
+    return m_location;
+}
+
+// Entry of the folder listing its pattern entries, so a lookup without an entry of its own doesn't have to list the
+// whole folder. It always holds the empty key, which tells a folder without patterns from one whose patterns were
+// never listed, e.g. as it was written by an older version.
+static constexpr QLatin1String patternMapKey(".patterns");
+
+static QMap<QString, QString> patternMap(const QStringList &keys)
+{
+    QMap<QString, QString> patterns{{QString(), QString()}};
+    for (const QString &key : keys) {
+        if (PatternIndex::isPattern(key)) {
+            patterns.insert(key, QString());
+        }
+    }
+    return patterns;
+}
+
+const PatternIndex &SecretStore::patterns()
+{
+    const qint64 maximumAge = 60 * 1000;
+    if (!m_patterns || m_patternsAge.hasExpired(maximumAge)) {
+        QMap<QString, QString> patterns = readMap(patternMapKey);
+        if (!patterns.contains(QString())) {
+            const QStringList keys = entryList();
+            patterns = patternMap(keys);
+            // A folder that doesn't exist yet isn't created for this
+            if (!keys.isEmpty()) {
+                writeMap(patternMapKey, patterns);
+            }
+        }
+        m_patterns = std::make_unique<PatternIndex>(patterns.keys());
+        m_patternsAge.start();
+    }
+    return *m_patterns;
+}
+
+void SecretStore::updatePatterns(const QString &removed, const QString &added)
+{
+    const bool removesPattern = !removed.isNull() && PatternIndex::isPattern(removed);
+    const bool addsPattern = !added.isNull() && PatternIndex::isPattern(added);
+    if (!removesPattern && !addsPattern) {
+        return;
+    }
+    QMap<QString, QString> patterns = readMap(patternMapKey);
+    if (!patterns.contains(QString())) {
+        patterns = patternMap(entryList());
+    } else {
+        if (removesPattern) {
+            patterns.remove(removed);
+        }
+        if (addsPattern) {
+            patterns.insert(added, QString());
+        }
+    }
+    writeMap(patternMapKey, patterns);
+    m_patterns.reset();
+}
+
+void SecretStore::refreshPatterns()
+{
+    const QMap<QString, QString> patterns = patternMap(entryList());
+    if (readMap(patternMapKey) != patterns) {
+        writeMap(patternMapKey, patterns);
+    }
+    m_patterns.reset();
+}
+
+static WalletLocation parseLocation(const QString &route)
+{
+    const int slash = route.indexOf(QLatin1Char('/'));
+    if (slash < 0) {
+        return WalletLocation{QStringLiteral("NetworkWallet"), route};
+    }
+    return WalletLocation{route.left(slash), route.mid(slash + 1)};
+}
+
+WalletLocation walletLocation(enum Category category)
+{
+    const QString route = settings(QStringLiteral("Wallets")).readEntry(categoryName(category), QString());
+    return route.isEmpty() ? defaultWalletLocation() : parseLocation(route);
+}
+
+WalletLocation defaultWalletLocation()
+{
+    return parseLocation(settings(QStringLiteral("Wallets")).readEntry("default", QStringLiteral("NetworkWallet/ksshaskpass")));
+}
+
+QList<WalletLocation> walletLocations()
+{
+    QList<WalletLocation> locations;
+    for (int category = CategoryOther; category <= CategoryGpg; ++category) {
+        const WalletLocation location = walletLocation(static_cast<Category>(category));
+        if (!locations.contains(location)) {
+            locations.append(location);
+        }
+    }
+    return locations;
+}
+
+std::unique_ptr<SecretStore> openSecretStore(const WalletLocation &location)
+{
+    const QString helper = qEnvironmentVariable("KSSHASKPASS_SECRET_HELPER");
+    if (!helper.isEmpty()) {
+        return std::make_unique<HelperSecretStore>(helper, location);
+    }
+#if HAVE_KWALLET
+    return KWalletStore::open(location);
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,99 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "patternindex.h"
+#include "prompt.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+// Where secrets are kept: a wallet, where NetworkWallet and LocalWallet stand for the wallets KWallet is set up to
+// use for those, and a folder in it.
+struct WalletLocation {
+    QString wallet;
+    QString folder;
+
+    bool operator==(const WalletLocation &other) const
+    {
+        return wallet == other.wallet && folder == other.folder;
+    }
+};
+
+// Storage for the secrets the user asked us to keep. Entries live in a folder, which the KWallet
+// backend maps to a wallet folder and a secret helper receives as an argument.
+class SecretStore
+{
+public:
+    explicit SecretStore(const WalletLocation &location);
+    virtual ~SecretStore() = default;
+
+    const WalletLocation &location() const;
+
+    // Returns a null string if there is no entry for key.
+    virtual QString readPassword(const QString &key) = 0;
+    virtual bool writePassword(const QString &key, const QString &value) = 0;
+    virtual bool renameEntry(const QString &oldKey, const QString &newKey) = 0;
+    virtual bool removeEntry(const QString &key) = 0;
+    virtual QStringList entryList() = 0;
+
+    // Returns an empty map if there is no entry for key.
+    virtual QMap<QString, QString> readMap(const QString &key) = 0;
+    virtual bool writeMap(const QString &key, const QMap<QString, QString> &value) = 0;
+
+    // Whether the store can still be used. A wallet is closed when the user locks it or kwalletd closes it after
+    // some idle time, after which every read fails.
+    virtual bool isOpen() const
+    {
+        return true;
+    }
+
+    // The pattern entries of the folder, as listed in its .patterns map, so a lookup costs one read of the map
+    // instead of listing the folder. The folder is only listed if it has no such map yet. The map is read when
+    // first needed and again after a minute, as other processes may change it too.
+    const PatternIndex &patterns();
+
+protected:
+    // Stores call this once the entry added was written, or the entry removed renamed to added, to keep .patterns
+    // up to date. Either may be a null string. Costs nothing unless one of them is a pattern.
+    void updatePatterns(const QString &removed, const QString &added);
+
+    // Lists the pattern entries of the folder again, for stores that learn that other programs changed it.
+    void refreshPatterns();
+
+private:
+    const WalletLocation m_location;
+    std::unique_ptr<PatternIndex> m_patterns;
+    QElapsedTimer m_patternsAge;
+};
+
+// Where the secrets of category are kept, as [Wallets] in the settings routes it: <category>=<wallet>/<folder>.
+// Categories without a route use the "default" one, or else the ksshaskpass folder of the network wallet.
+WalletLocation walletLocation(enum Category category);
+
+// Where the secrets of categories without a route of their own are kept.
+WalletLocation defaultWalletLocation();
+
+// Every location some category is routed to, each once.
+QList<WalletLocation> walletLocations();
+
+// Opens the store for location. If KSSHASKPASS_SECRET_HELPER is set, the command it names is used
+// instead of KWallet:
+//
+//   <helper> get <folder> <key>     prints the secret, exits non-zero if there is none
+//   <helper> store <folder> <key>   reads the secret from stdin
+//   <helper> erase <folder> <key>
+//   <helper> list <folder>          prints the keys of the folder, one per line
+//
+// Maps are passed to and from the helper as JSON objects.
+//
+// The helper only gets the folder, wallets are left to it. Returns nullptr if no store is available.
+std::unique_ptr<SecretStore> openSecretStore(const WalletLocation &location);
@@ -0,0 +1,111 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "sessioncache.h"
+
+#ifdef Q_OS_LINUX
+#include <linux/keyctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Possessor may do anything. Other processes of the user may write, search, link and set attributes, but neither
+// view nor read the secret. Other users get nothing.
+static const unsigned long keyPermissions = 0x3f3c0000;
+
+static QByteArray description(const QString &name)
+{
+    return QByteArrayLiteral("ksshaskpass:") + name.toUtf8();
+}
+
+// The keyring to use, or 0 if there is none. A process without a session keyring of its own would get the user
+// session keyring for KEY_SPEC_SESSION_KEYRING, which is shared by all sessions of the user again.
+static long keyringId(SessionCache::Keyring keyring)
+{
+    if (keyring == SessionCache::UserKeyring) {
+        return KEY_SPEC_USER_KEYRING;
+    }
+    const long session = syscall(__NR_keyctl, KEYCTL_GET_KEYRING_ID, KEY_SPEC_SESSION_KEYRING, 0);
+    const long userSession = syscall(__NR_keyctl, KEYCTL_GET_KEYRING_ID, KEY_SPEC_USER_SESSION_KEYRING, 0);
+    return (session < 0 || session == userSession) ? 0 : session;
+}
+
+static long findKey(const QString &name, SessionCache::Keyring keyring)
+{
+    const long id = keyringId(keyring);
+    if (id == 0) {
+        return -1;
+    }
+    return syscall(__NR_keyctl, KEYCTL_SEARCH, id, "user", description(name).constData(), 0);
+}
+
+bool SessionCache::store(const QString &name, const QByteArray &secret, int timeout, Keyring keyring)
+{
+    const long id = keyringId(keyring);
+    if (id == 0) {
+        return false;
+    }
+    const long key = syscall(__NR_add_key, "user", description(name).constData(), secret.constData(), size_t(secret.size()), id);
+    if (key < 0) {
+        return false;
+    }
+    syscall(__NR_keyctl, KEYCTL_SETPERM, key, keyPermissions);
+    if (syscall(__NR_keyctl, KEYCTL_SET_TIMEOUT, key, timeout) < 0) {
+        syscall(__NR_keyctl, KEYCTL_INVALIDATE, key);
+        return false;
+    }
+    return true;
+}
+
+QByteArray SessionCache::lookup(const QString &name, Keyring keyring)
+{
+    const long key = findKey(name, keyring);
+    if (key < 0) {
+        return QByteArray();
+    }
+    // The size may change between asking for it and reading, so read until it fits
+    QByteArray secret;
+    for (;;) {
+        const long size = syscall(__NR_keyctl, KEYCTL_READ, key, secret.data(), size_t(secret.size()));
+        if (size < 0) {
+            return QByteArray();
+        }
+        if (size <= secret.size()) {
+            secret.truncate(size);
+            return secret;
+        }
+        secret.resize(size);
+    }
+}
+
+void SessionCache::remove(const QString &name, Keyring keyring)
+{
+    const long key = findKey(name, keyring);
+    if (key >= 0) {
+        syscall(__NR_keyctl, KEYCTL_INVALIDATE, key);
+    }
+}
+#else
+bool SessionCache::store(const QString &name, const QByteArray &secret, int timeout, Keyring keyring)
+{
+    Q_UNUSED(name)
+    Q_UNUSED(secret)
+    Q_UNUSED(timeout)
+    Q_UNUSED(keyring)
+    return false;
+}
+
+QByteArray SessionCache::lookup(const QString &name, Keyring keyring)
+{
+    Q_UNUSED(name)
+    Q_UNUSED(keyring)
+    return QByteArray();
+}
+
+void SessionCache::remove(const QString &name, Keyring keyring)
+{
+    Q_UNUSED(name)
+    Q_UNUSED(keyring)
+}
+#endif
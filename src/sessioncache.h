@@ -0,0 +1,30 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+// Short-lived secrets shared between ksshaskpass processes of one user, for answers that must not be kept in the
+// wallet. They are held in a kernel keyring, so they never touch the disk and the kernel drops them once they
+// expire. Only available on Linux, elsewhere nothing is ever cached.
+namespace SessionCache
+{
+enum Keyring {
+    // Shared by every process of the user, whichever session it belongs to
+    UserKeyring,
+    // Only seen by the processes of one login session, as set up by pam_keyinit. Without one nothing is kept.
+    LoginSessionKeyring,
+};
+
+// Keeps secret under name for timeout seconds, replacing what was there.
+bool store(const QString &name, const QByteArray &secret, int timeout, Keyring keyring = UserKeyring);
+
+// Returns the secret kept under name, or a null byte array if there is none or it expired.
+QByteArray lookup(const QString &name, Keyring keyring = UserKeyring);
+
+void remove(const QString &name, Keyring keyring = UserKeyring);
+}
@@ -0,0 +1,15 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+// Returns a group of ksshaskpassrc. The settings are described in the README.
+inline KConfigGroup settings(const QString &group = QStringLiteral("General"))
+{
+    return KConfigGroup(KSharedConfig::openConfig(QStringLiteral("ksshaskpassrc"), KConfig::NoGlobals), group);
+}
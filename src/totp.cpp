@@ -0,0 +1,89 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "totp.h"
+
+#include <QMessageAuthenticationCode>
+#include <QUrl>
+#include <QUrlQuery>
+
+#include <QtEndian>
+
+#include <cstring>
+
+static QByteArray decodeBase32(const QString &encoded)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+    QByteArray decoded;
+    quint32 buffer = 0;
+    int bits = 0;
+    for (const QChar c : encoded) {
+        if (c.isSpace() || c == QLatin1Char('=') || c == QLatin1Char('-')) {
+            continue;
+        }
+        const char *position = c.unicode() < 128 ? strchr(alphabet, c.toUpper().toLatin1()) : nullptr;
+        if (!position || !*position) {
+            return QByteArray();
+        }
+        buffer = (buffer << 5) | quint32(position - alphabet);
+        bits += 5;
+        if (bits >= 8) {
+            bits -= 8;
+            decoded.append(char((buffer >> bits) & 0xff));
+        }
+    }
+    return decoded;
+}
+
+QString totpCode(const QString &seed, qint64 now)
+{
+    QString secret = seed.trimmed();
+    QCryptographicHash::Algorithm algorithm = QCryptographicHash::Sha1;
+    int digits = 6;
+    int period = 30;
+
+    if (secret.startsWith(QLatin1String("otpauth://"))) {
+        const QUrl url(secret);
+        if (url.host() != QLatin1String("totp")) {
+            return QString();
+        }
+        const QUrlQuery query(url);
+        secret = query.queryItemValue(QStringLiteral("secret"));
+        const QString algorithmName = query.queryItemValue(QStringLiteral("algorithm")).toUpper();
+        if (algorithmName == QLatin1String("SHA256")) {
+            algorithm = QCryptographicHash::Sha256;
+        } else if (algorithmName == QLatin1String("SHA512")) {
+            algorithm = QCryptographicHash::Sha512;
+        } else if (!algorithmName.isEmpty() && algorithmName != QLatin1String("SHA1")) {
+            return QString();
+        }
+        if (query.hasQueryItem(QStringLiteral("digits"))) {
+            digits = query.queryItemValue(QStringLiteral("digits")).toInt();
+        }
+        if (query.hasQueryItem(QStringLiteral("period"))) {
+            period = query.queryItemValue(QStringLiteral("period")).toInt();
+        }
+    }
+
+    const QByteArray key = decodeBase32(secret);
+    if (key.isEmpty() || digits < 6 || digits > 9 || period <= 0) {
+        return QString();
+    }
+
+    QByteArray counter(8, Qt::Uninitialized);
+    qToBigEndian(quint64(now / period), counter.data());
+    const QByteArray mac = QMessageAuthenticationCode::hash(counter, key, algorithm);
+
+    // Dynamic truncation as in RFC 4226
+    const int offset = mac.at(mac.size() - 1) & 0x0f;
+    const quint32 binary = (quint32(uchar(mac.at(offset)) & 0x7f) << 24) | (quint32(uchar(mac.at(offset + 1))) << 16)
+        | (quint32(uchar(mac.at(offset + 2))) << 8) | quint32(uchar(mac.at(offset + 3)));
+    quint32 modulus = 1;
+    for (int i = 0; i < digits; ++i) {
+        modulus *= 10;
+    }
+    return QStringLiteral("%1").arg(binary % modulus, digits, 10, QLatin1Char('0'));
+}
@@ -0,0 +1,14 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QString>
+
+// Computes the time-based one-time password (RFC 6238) for a seed, which is either the base32 secret or an
+// otpauth://totp/ URI with optional algorithm, digits and period parameters. Returns a null string if the seed
+// can't be used.
+QString totpCode(const QString &seed, qint64 now = QDateTime::currentSecsSinceEpoch());
@@ -0,0 +1,124 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "ttyprompt.h"
+
+#include <KLocalizedString>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+class Terminal
+{
+public:
+    Terminal()
+        : m_fd(::open("/dev/tty", O_RDWR | O_CLOEXEC | O_NOCTTY))
+    {
+    }
+
+    ~Terminal()
+    {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+
+    bool isOpen() const
+    {
+        return m_fd >= 0;
+    }
+
+    void write(const QString &text)
+    {
+        const QByteArray data = text.toLocal8Bit();
+        qsizetype written = 0;
+        while (written < data.size()) {
+            const ssize_t n = ::write(m_fd, data.constData() + written, data.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            written += n;
+        }
+    }
+
+    bool readLine(bool echo, QByteArray &line)
+    {
+        struct termios saved;
+        const bool isTty = tcgetattr(m_fd, &saved) == 0;
+        if (isTty && !echo) {
+            struct termios silent = saved;
+            silent.c_lflag &= ~(ECHO | ECHONL);
+            tcsetattr(m_fd, TCSAFLUSH, &silent);
+        }
+
+        bool complete = false;
+        char c;
+        for (;;) {
+            const ssize_t n = ::read(m_fd, &c, 1);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            if (c == '\n' || c == '\r') {
+                complete = true;
+                break;
+            }
+            line.append(c);
+        }
+
+        if (isTty && !echo) {
+            tcsetattr(m_fd, TCSAFLUSH, &saved);
+            write(QStringLiteral("\n"));
+        }
+        return complete;
+    }
+
+private:
+    const int m_fd;
+};
+}
+
+bool readFromTerminal(const QString &prompt, bool echo, QString &answer)
+{
+    Terminal terminal;
+    if (!terminal.isOpen()) {
+        return false;
+    }
+
+    terminal.write(prompt);
+    QByteArray line;
+    if (!terminal.readLine(echo, line)) {
+        return false;
+    }
+    answer = QString::fromLocal8Bit(line);
+    return true;
+}
+
+bool confirmOnTerminal(const QString &prompt)
+{
+    QString answer;
+    if (!readFromTerminal(prompt + i18nc("Appended to a yes/no question on the terminal", " [y/N] "), true, answer)) {
+        return false;
+    }
+    answer = answer.trimmed().toLower();
+    return answer == QLatin1String("y") || answer == QLatin1String("yes") || answer == i18nc("Affirmative answer on the terminal", "yes");
+}
+
+void writeToTerminal(const QString &message)
+{
+    Terminal terminal;
+    if (terminal.isOpen()) {
+        terminal.write(message);
+    }
+}
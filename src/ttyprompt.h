@@ -0,0 +1,21 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QString>
+
+// Terminal prompts used when ksshaskpass is built without dialogs. They talk to the controlling
+// terminal directly, since stdout belongs to the program that asked for the passphrase.
+
+// Reads a line from the terminal, hiding it unless echo is set. Returns false if there is no
+// terminal or the input was aborted.
+bool readFromTerminal(const QString &prompt, bool echo, QString &answer);
+
+// Asks a yes/no question on the terminal, anything but yes counts as no.
+bool confirmOnTerminal(const QString &prompt);
+
+// Shows a message on the terminal, if there is one.
+void writeToTerminal(const QString &message);
@@ -0,0 +1,292 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "walletentry.h"
+
+#include "keyverifier.h"
+#include "ksshaskpass_debug.h"
+#include "prompt.h"
+#include "secretstore.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+
+// Entry of the wallet folder mapping canonical identifiers to the key of the alias group they belong to.
+static constexpr QLatin1String aliasMapKey(".aliases");
+
+static QString aliasGroupKey(const QString &group)
+{
+    return QStringLiteral("group:") + group;
+}
+
+// Returns the key the secret for the canonical identifier key is stored under, which is the key of its alias
+// group if it has one.
+static QString resolveAlias(SecretStore &wallet, const QString &key)
+{
+    return wallet.readMap(aliasMapKey).value(key, key);
+}
+
+// Entry of the wallet folder mapping key files to the fingerprint they had when their passphrase was stored.
+static constexpr QLatin1String fingerprintMapKey(".fingerprints");
+
+// Key files are small, anything bigger is not one.
+static const qint64 maximumKeySize = 1024 * 1024;
+
+static bool isKeyFile(const QString &path)
+{
+    const QFileInfo info(path);
+    return info.isFile() && info.size() <= maximumKeySize;
+}
+
+// Identifies the contents of a key file. Changing the passphrase of a key rewrites it with a new salt, so a
+// stored passphrase whose fingerprint doesn't match any more is known to be stale. Returns a null string if the
+// file can't be read.
+static QString keyFileFingerprint(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return QString();
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+// Returns whether item, stored for the key file with the given canonical path, was stored for the file as it is
+// now. Items stored before fingerprints were recorded are taken as they are, and their fingerprint is recorded.
+static bool matchesKeyFile(SecretStore &wallet, QMap<QString, QString> &fingerprints, const QString &path, const QString &fingerprint)
+{
+    const QString stored = fingerprints.value(path);
+    if (stored.isEmpty()) {
+        fingerprints.insert(path, fingerprint);
+        wallet.writeMap(fingerprintMapKey, fingerprints);
+        return true;
+    }
+    return stored == fingerprint;
+}
+
+// Entry of the wallet folder mapping canonical identifiers to a digest of an item that turned out to be wrong for
+// them. Members of an alias group are rejected one by one, the item may still be right for the others.
+static constexpr QLatin1String rejectedMapKey(".rejected");
+
+// Reads the item stored under key, which is the canonical form of identifier or the key of its alias group.
+// Entries written by older versions under other spellings of the identifier are renamed to key when found, and so
+// are entries left at the default location before the category of wallet got a route of its own. If there is no
+// entry for key, the most specific pattern entry matching it is used with matchPatterns.
+static QString readItem(SecretStore &wallet, const QString &identifier, const QString &key, bool matchPatterns)
+{
+    QString item = wallet.readPassword(key);
+    if (!item.isEmpty()) {
+        return item;
+    }
+
+    // Before identifiers were canonicalized they were stored as given in the prompt. There was also a bug in
+    // previous versions of ksshaskpass that caused it to create keys with single quotes around the identifier and
+    // even older versions have an extra space appended to the identifier. Try these keys too, and, if there's a
+    // match, ensure that it's properly replaced with proper one.
+    QStringList legacyKeys;
+    for (const QString &spelling : {canonicalIdentifier(identifier), identifier}) {
+        if (spelling != key && !legacyKeys.contains(spelling)) {
+            legacyKeys << spelling;
+        }
+    }
+    for (auto templ : QStringList{QStringLiteral("'%0'"), QStringLiteral("%0 "), QStringLiteral("'%0' ")}) {
+        legacyKeys << templ.arg(identifier);
+    }
+    for (const QString &legacyKey : std::as_const(legacyKeys)) {
+        item = wallet.readPassword(legacyKey);
+        if (!item.isEmpty()) {
+            qCWarning(LOG_KSSHASKPASS) << "Detected legacy key for " << identifier << ", enabling workaround";
+            wallet.renameEntry(legacyKey, key);
+            break;
+        }
+    }
+
+    // Entries stored before [Wallets] routed this category elsewhere are moved over. Alias groups stay where they
+    // are, their other members may still be read from there.
+    if (item.isEmpty() && !(wallet.location() == defaultWalletLocation())) {
+        std::unique_ptr<SecretStore> old = openSecretStore(defaultWalletLocation());
+        if (old) {
+            const QString canonical = canonicalIdentifier(identifier);
+            const QString oldKey = resolveAlias(*old, canonical);
+            item = readItem(*old, identifier, oldKey, false);
+            if (!item.isEmpty() && wallet.writePassword(key, item)) {
+                qCDebug(LOG_KSSHASKPASS) << "Moved the entry for" << identifier << "to its own wallet";
+                if (oldKey == canonical) {
+                    old->removeEntry(oldKey);
+                }
+            }
+        }
+    }
+
+    // Fall back to the most specific pattern entry, e.g. one password for *.build.corp
+    if (item.isEmpty() && matchPatterns) {
+        const QString pattern = wallet.patterns().match(key);
+        if (!pattern.isNull()) {
+            item = wallet.readPassword(pattern);
+        }
+    }
+    return item;
+}
+
+WalletEntry::WalletEntry(SecretStore *wallet, const QString &identifier, bool matchPatterns)
+    : m_wallet(identifier.isNull() ? nullptr : wallet)
+    , m_identifier(identifier)
+    , m_matchPatterns(matchPatterns)
+{
+    if (!m_wallet) {
+        return;
+    }
+    // One key file or host may be spelled in different ways, and several keys may share a passphrase. All of
+    // them are stored under one key.
+    m_canonical = canonicalIdentifier(identifier);
+    m_key = resolveAlias(*m_wallet, m_canonical);
+    m_isKeyFile = isKeyFile(m_canonical);
+}
+
+WalletEntry::WalletEntry(const WalletLocation &location, const QString &identifier)
+    : m_wallet(nullptr)
+    , m_identifier(identifier)
+    , m_matchPatterns(false)
+{
+    if (identifier.isNull()) {
+        return;
+    }
+    m_deferredLocation = location;
+    m_canonical = canonicalIdentifier(identifier);
+    m_isKeyFile = isKeyFile(m_canonical);
+}
+
+WalletEntry::~WalletEntry() = default;
+
+bool WalletEntry::isValid() const
+{
+    return m_wallet || m_deferredLocation;
+}
+
+QString WalletEntry::keyFile() const
+{
+    return m_isKeyFile ? m_canonical : QString();
+}
+
+SecretStore *WalletEntry::wallet()
+{
+    if (m_deferredLocation) {
+        m_openedWallet = openSecretStore(*m_deferredLocation);
+        m_deferredLocation.reset();
+        m_wallet = m_openedWallet.get();
+        if (m_wallet) {
+            m_key = resolveAlias(*m_wallet, m_canonical);
+        }
+    }
+    return m_wallet;
+}
+
+const QString &WalletEntry::fingerprint()
+{
+    if (!m_fingerprint) {
+        m_fingerprint = keyFileFingerprint(m_canonical);
+    }
+    return *m_fingerprint;
+}
+
+QMap<QString, QString> &WalletEntry::fingerprints()
+{
+    if (!m_fingerprints) {
+        m_fingerprints = m_wallet->readMap(fingerprintMapKey);
+    }
+    return *m_fingerprints;
+}
+
+QMap<QString, QString> &WalletEntry::rejected()
+{
+    if (!m_rejected) {
+        m_rejected = m_wallet->readMap(rejectedMapKey);
+    }
+    return *m_rejected;
+}
+
+QString WalletEntry::read(bool verifyKey)
+{
+    SecretStore *store = wallet();
+    if (!store) {
+        return QString();
+    }
+
+    QString item = readItem(*store, m_identifier, m_key, m_matchPatterns);
+
+    // A key file that changed since its passphrase was stored most likely has a new passphrase
+    if (!item.isEmpty() && m_isKeyFile && !fingerprint().isNull() && !matchesKeyFile(*store, fingerprints(), m_canonical, fingerprint())) {
+        qCWarning(LOG_KSSHASKPASS) << "Key file" << m_canonical << "changed since its passphrase was stored, ignoring the stored one";
+        item.clear();
+    }
+    if (!item.isEmpty() && rejected().value(m_canonical) == digest(item)) {
+        qCWarning(LOG_KSSHASKPASS) << "The item stored for" << m_identifier << "was rejected before, ignoring it";
+        item.clear();
+    }
+    // Not remembered as rejected, the check may be wrong about it, e.g. with a key ssh-keygen can't read
+    if (!item.isEmpty() && verifyKey && m_isKeyFile && verifyKeyPassphrase(m_canonical, item) == KeyCheck::Mismatch) {
+        qCWarning(LOG_KSSHASKPASS) << "The passphrase stored for" << m_identifier << "does not unlock it, ignoring it";
+        item.clear();
+    }
+    return item;
+}
+
+void WalletEntry::write(const QString &item)
+{
+    SecretStore *store = wallet();
+    if (!store) {
+        return;
+    }
+    // Stores the fingerprint of the key file along with its passphrase
+    store->writePassword(m_key, item);
+    if (m_isKeyFile && !fingerprint().isNull()) {
+        fingerprints().insert(m_canonical, fingerprint());
+        store->writeMap(fingerprintMapKey, fingerprints());
+    }
+}
+
+QString WalletEntry::digest(const QString &item) const
+{
+    const QByteArray data = (m_canonical + QLatin1Char('\n') + item).toUtf8();
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
+
+void WalletEntry::reject(const QString &digest)
+{
+    if (!digest.isEmpty() && wallet()) {
+        rejected().insert(m_canonical, digest);
+        m_wallet->writeMap(rejectedMapKey, rejected());
+    }
+}
+
+bool addToAliasGroup(SecretStore &wallet, const QString &group, const QStringList &identifiers)
+{
+    // The group lives with key passphrases, hosts routed elsewhere would never look it up
+    for (const QString &identifier : identifiers) {
+        if (!isKeyFile(canonicalIdentifier(identifier))) {
+            qCWarning(LOG_KSSHASKPASS) << identifier << "is not a key file, only keys can share a passphrase";
+            return false;
+        }
+    }
+
+    const QString groupKey = aliasGroupKey(group);
+    QString item = wallet.readPassword(groupKey);
+    QMap<QString, QString> aliases = wallet.readMap(aliasMapKey);
+    for (const QString &identifier : identifiers) {
+        const QString key = canonicalIdentifier(identifier);
+        if (item.isEmpty()) {
+            item = wallet.readPassword(key);
+            if (!item.isEmpty()) {
+                wallet.writePassword(groupKey, item);
+            }
+        }
+        aliases.insert(key, groupKey);
+    }
+    return wallet.writeMap(aliasMapKey, aliases);
+}
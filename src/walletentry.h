@@ -0,0 +1,75 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "secretstore.h"
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+#include <optional>
+
+// The stored answer for one identifier: which key of the wallet folder it lives under, and whether what is stored
+// there can still be trusted.
+class WalletEntry
+{
+public:
+    // wallet may be nullptr, in which case nothing is ever read or written. With matchPatterns, an identifier
+    // without an entry of its own is answered by the most specific pattern entry matching it, which is only
+    // meant for passwords.
+    WalletEntry(SecretStore *wallet, const QString &identifier, bool matchPatterns = false);
+    // Like the above, but the store for location is only opened once it is used, e.g. to keep what the user typed.
+    // For a process that knows the wallet is available, but has nothing to look up in it.
+    WalletEntry(const WalletLocation &location, const QString &identifier);
+    ~WalletEntry();
+
+    bool isValid() const;
+
+    // The canonical path of the key file the identifier names, or a null string if it doesn't name one.
+    QString keyFile() const;
+
+    // Returns the stored item, or an empty string if there is none that can be used. With verifyKey, a
+    // passphrase for a key file is checked against the key before it is returned.
+    QString read(bool verifyKey);
+
+    void write(const QString &item);
+
+    // Identifies an item read from this entry without revealing it, so it can be recognized when it is rejected.
+    QString digest(const QString &item) const;
+
+    // Remembers that the item with the given digest, which was answered from this entry, was rejected by the
+    // program that asked for it, so it is never answered with again for this identifier.
+    void reject(const QString &digest);
+
+private:
+    // The store, opened first if that was put off. nullptr if there is none.
+    SecretStore *wallet();
+
+    // The fingerprint of the key file, taken when first needed.
+    const QString &fingerprint();
+
+    // The bookkeeping maps of the wallet folder, each read once when first needed.
+    QMap<QString, QString> &fingerprints();
+    QMap<QString, QString> &rejected();
+
+    SecretStore *m_wallet;
+    std::unique_ptr<SecretStore> m_openedWallet;
+    std::optional<WalletLocation> m_deferredLocation;
+    const QString m_identifier;
+    const bool m_matchPatterns;
+    QString m_canonical;
+    QString m_key;
+    bool m_isKeyFile = false;
+    std::optional<QString> m_fingerprint;
+    std::optional<QMap<QString, QString>> m_fingerprints;
+    std::optional<QMap<QString, QString>> m_rejected;
+};
+
+// Adds identifiers to the alias group, so they all use the one secret stored for it. If the group has no secret
+// yet, the first one already stored for a member is taken over.
+bool addToAliasGroup(SecretStore &wallet, const QString &group, const QStringList &identifiers);
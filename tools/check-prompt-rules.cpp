@@ -0,0 +1,482 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+// Compares how the table of rules in src/prompt.cpp classifies prompts with the chain of regular expressions it
+// replaced, which is kept below as it was. Run it with "make check-prompt-rules".
+//
+// The rules are meant to classify every prompt the same, with these exceptions, which the samples expect:
+// - An identifier is only compared for being empty where the expressions captured an empty string and the
+//   rules give a null one.
+// - One-time password prompts only get an identifier from the "(user@host) " OpenSSH 8.7 and later put in front,
+//   so a code for one server is never sent to another. pam_oath seeds are looked up under that user@host too.
+// - Prompts longer than 4096 characters are not parsed.
+//
+// With --list, the sample prompts are written to stdout instead, each followed by a null character. They are the
+// prompt corpus tools/pgo-train.sh trains a profile-guided build with.
+
+#include "prompt.h"
+
+#include <QCoreApplication>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QTextStream>
+
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+struct Classification {
+    QString identifier;
+    enum Type type = TypePassword;
+    enum Category category = CategoryOther;
+    bool ignoreWallet = false;
+    bool retry = false;
+    bool sessionOnly = false;
+
+    bool operator==(const Classification &other) const
+    {
+        const bool sameIdentifier = identifier.isEmpty() ? other.identifier.isEmpty() : identifier == other.identifier;
+        return sameIdentifier && type == other.type && category == other.category && ignoreWallet == other.ignoreWallet && retry == other.retry
+            && sessionOnly == other.sessionOnly;
+    }
+};
+
+void legacyParsePrompt(const QString &prompt,
+                       QString &identifier,
+                       bool &ignoreWallet,
+                       enum Type &type,
+                       enum Category &category,
+                       bool &retry,
+                       bool &sessionOnly)
+{
+    QRegularExpressionMatch match;
+    category = CategoryOther;
+    retry = false;
+    sessionOnly = false;
+
+    // openssh sshconnect2.c
+    // Case: password for authentication on remote ssh server
+    match = QRegularExpression(QStringLiteral("^(.*@.*)'s password( \\(JPAKE\\))?: $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypePassword;
+        category = CategoryHost;
+        ignoreWallet = false;
+        return;
+    }
+
+    // openssh sshconnect2.c
+    // Case: password change request
+    match = QRegularExpression(QStringLiteral("^(Enter|Retype) (.*@.*)'s (old|new) password: $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(2);
+        type = TypePassword;
+        category = CategoryHost;
+        ignoreWallet = true;
+        return;
+    }
+
+    // openssh sshconnect2.c and sshconnect1.c
+    // Case: asking for passphrase for a certain keyfile
+    match = QRegularExpression(QStringLiteral("^Enter passphrase for( RSA)? key '(.*)': $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(2);
+        type = TypePassword;
+        category = CategoryKey;
+        ignoreWallet = false;
+        return;
+    }
+
+    // openssh ssh-add.c
+    // Case: asking for passphrase for a certain keyfile for the first time => we should try a password from the wallet
+    match = QRegularExpression(QStringLiteral("^Enter passphrase for (.*?)( \\(will confirm each use\\))?: $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypePassword;
+        category = CategoryKey;
+        ignoreWallet = false;
+        return;
+    }
+
+    // openssh ssh-add.c
+    // Case: re-asking for passphrase for a certain keyfile => probably we've tried a password from the wallet, no point
+    // in trying it again, but the right one should replace it
+    match = QRegularExpression(QStringLiteral("^Bad passphrase, try again for (.*?)( \\(will confirm each use\\))?: $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypePassword;
+        category = CategoryKey;
+        ignoreWallet = true;
+        retry = true;
+        return;
+    }
+
+    // openssh ssh-pkcs11.c
+    // Case: asking for PIN for some token label
+    match = QRegularExpression(QStringLiteral("Enter PIN for '(.*)': $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypePassword;
+        category = CategoryKey;
+        ignoreWallet = false;
+        return;
+    }
+
+    // openssh mux.c
+    match = QRegularExpression(QStringLiteral("^(Allow|Terminate) shared connection to (.*)\\? $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(2);
+        type = TypeConfirm;
+        category = CategoryOther;
+        ignoreWallet = true;
+        return;
+    }
+
+    // openssh mux.c
+    match = QRegularExpression(QStringLiteral("^Open (.* on .*)?$")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypeConfirm;
+        category = CategoryOther;
+        ignoreWallet = true;
+        return;
+    }
+
+    // openssh mux.c
+    match = QRegularExpression(QStringLiteral("^Allow forward to (.*:.*)\\? $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypeConfirm;
+        category = CategoryOther;
+        ignoreWallet = true;
+        return;
+    }
+
+    // openssh mux.c
+    match = QRegularExpression(QStringLiteral("^Disable further multiplexing on shared connection to (.*)? $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypeConfirm;
+        category = CategoryOther;
+        ignoreWallet = true;
+        return;
+    }
+
+    // openssh ssh-agent.c
+    match = QRegularExpression(QStringLiteral("^Allow use of key (.*)?\\nKey fingerprint .*\\.$")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypeConfirm;
+        category = CategoryOther;
+        ignoreWallet = true;
+        return;
+    }
+
+    // openssh sshconnect.c
+    match = QRegularExpression(QStringLiteral("^Add key (.*) \\(.*\\) to agent\\?$")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypeConfirm;
+        category = CategoryOther;
+        ignoreWallet = true;
+        return;
+    }
+
+    // git imap-send.c
+    // Case: asking for password by git imap-send
+    match = QRegularExpression(QStringLiteral("^Password \\((.*@.*)\\): $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypePassword;
+        category = CategoryGit;
+        ignoreWallet = false;
+        return;
+    }
+
+    // git credential.c
+    // Case: asking for username by git without specifying any other information
+    match = QRegularExpression(QStringLiteral("^Username: $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = QString();
+        type = TypeClearText;
+        category = CategoryGit;
+        ignoreWallet = true;
+        return;
+    }
+
+    // git credential.c
+    // Case: asking for password by git without specifying any other information
+    match = QRegularExpression(QStringLiteral("^Password: $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = QString();
+        type = TypePassword;
+        category = CategoryGit;
+        ignoreWallet = true;
+        return;
+    }
+
+    // git credential.c
+    // Case: asking for username by git for some identifier
+    match = QRegularExpression(QStringLiteral("^Username for '(.*)': $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypeClearText;
+        category = CategoryGit;
+        ignoreWallet = false;
+        return;
+    }
+
+    // git credential.c
+    // Case: asking for password by git for some identifier
+    match = QRegularExpression(QStringLiteral("^Password for '(.*)': $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypePassword;
+        category = CategoryGit;
+        ignoreWallet = false;
+        return;
+    }
+
+    // Case: username extraction from git-lfs
+    match = QRegularExpression(QStringLiteral("^Username for \"(.*?)\"$")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypeClearText;
+        category = CategoryGit;
+        ignoreWallet = false;
+        return;
+    }
+
+    // Case: password extraction from git-lfs
+    match = QRegularExpression(QStringLiteral("^Password for \"(.*?)\"$")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypePassword;
+        category = CategoryGit;
+        ignoreWallet = false;
+        return;
+    }
+
+    // sudo -A with SUDO_ASKPASS, default SUDO_PROMPT
+    // Case: login password of the user for sudo => never goes to the wallet, but may be remembered for a while
+    match = QRegularExpression(QStringLiteral("^\\[sudo\\] password for (.*): $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = QStringLiteral("sudo:") + match.captured(1);
+        type = TypePassword;
+        category = CategoryOther;
+        ignoreWallet = true;
+        sessionOnly = true;
+        return;
+    }
+
+    // OpenSSH keyboard-interactive with pam_google_authenticator, prefixed with "(user@host) " since OpenSSH 8.7
+    // Case: time-based one-time password => computed from a seed stored in the wallet, the code itself is never stored
+    match = QRegularExpression(QStringLiteral("^(?:\\((.*)\\) )?Verification code: $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = QStringLiteral("otp:") + match.captured(1);
+        type = TypeOtp;
+        category = CategoryOtp;
+        ignoreWallet = false;
+        return;
+    }
+
+    // pam_oath
+    // Case: time-based one-time password for a user => as above
+    match = QRegularExpression(QStringLiteral("^(?:\\(.*\\) )?One-time password \\(OATH\\) for `(.*)': $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = QStringLiteral("otp:") + match.captured(1);
+        type = TypeOtp;
+        category = CategoryOtp;
+        ignoreWallet = false;
+        return;
+    }
+
+    // Case: password extraction from mercurial, see bug 380085
+    match = QRegularExpression(QStringLiteral("^(.*?)'s password: $")).match(prompt);
+    if (match.hasMatch()) {
+        identifier = match.captured(1);
+        type = TypePassword;
+        category = CategoryOther;
+        ignoreWallet = false;
+        return;
+    }
+}
+
+Classification legacyClassification(const QString &prompt)
+{
+    Classification result;
+    legacyParsePrompt(prompt, result.identifier, result.ignoreWallet, result.type, result.category, result.retry, result.sessionOnly);
+    return result;
+}
+
+Classification classification(const QString &prompt)
+{
+    const ParsedPrompt parsed(prompt);
+    Classification result;
+    result.identifier = parsed.identifier;
+    result.type = parsed.type;
+    result.category = parsed.category;
+    result.ignoreWallet = parsed.ignoreWallet;
+    result.retry = parsed.retry;
+    result.sessionOnly = parsed.sessionOnly;
+    return result;
+}
+
+QString describe(const Classification &c)
+{
+    return QStringLiteral("identifier=\"%1\"%2 type=%3 category=%4 ignoreWallet=%5 retry=%6 sessionOnly=%7")
+        .arg(c.identifier, c.identifier.isNull() ? QStringLiteral(" (null)") : QString())
+        .arg(int(c.type))
+        .arg(categoryName(c.category))
+        .arg(int(c.ignoreWallet))
+        .arg(int(c.retry))
+        .arg(int(c.sessionOnly));
+}
+
+// Prompts both have to classify the same
+const char *const samePrompts[] = {
+    // ssh passwords
+    "user@host's password: ",
+    "user@host.example.org's password: ",
+    "user@host's password (JPAKE): ",
+    "user@host's password: user@other's password: ",
+    "user@host's password: \n",
+    "user@host's password:",
+    "host's password: ",
+    "first line\nuser@host's password: ",
+    // expired passwords
+    "Enter user@host's old password: ",
+    "Enter user@host's new password: ",
+    "Retype user@host's old password: ",
+    "Retype user@host's new password: ",
+    "Enter host's new password: ",
+    // key passphrases
+    "Enter passphrase for key '/home/user/.ssh/id_ed25519': ",
+    "Enter passphrase for RSA key '/home/user/.ssh/id_rsa': ",
+    "Enter passphrase for key '': ",
+    "Enter passphrase for /home/user/.ssh/id_ed25519: ",
+    "Enter passphrase for /home/user/.ssh/id_ed25519 (will confirm each use): ",
+    "Enter passphrase for /home/user/my key (will confirm each use) (will confirm each use): ",
+    "Enter passphrase for : ",
+    "Enter passphrase for /home/user/.ssh/id_ed25519: \n",
+    "Bad passphrase, try again for /home/user/.ssh/id_ed25519: ",
+    "Bad passphrase, try again for /home/user/.ssh/id_ed25519 (will confirm each use): ",
+    // PINs
+    "Enter PIN for 'token label': ",
+    "Some text\nEnter PIN for 'token label': ",
+    "Prefix Enter PIN for 'token': ",
+    "Enter PIN for 'a': Enter PIN for 'b': ",
+    "Enter PIN for 'token label': \nmore",
+    // confirmations
+    "Allow shared connection to host? ",
+    "Terminate shared connection to host? ",
+    "Allow shared connection to ? ",
+    "Open ",
+    "Open socket on host",
+    "Open something",
+    "Allow forward to host:22? ",
+    "Allow forward to host? ",
+    "Disable further multiplexing on shared connection to host ",
+    "Disable further multiplexing on shared connection to  ",
+    "Allow use of key /home/user/.ssh/id_ed25519?\nKey fingerprint SHA256:abc.",
+    "Allow use of key \nKey fingerprint SHA256:abc.",
+    "Allow use of key x\nKey fingerprint SHA256:abc",
+    "Allow use of key x\nKey fingerprint .",
+    "Allow use of key x\nsomething else\nKey fingerprint SHA256:abc.",
+    "Add key /home/user/.ssh/id_ed25519 (user@laptop) to agent?",
+    "Add key /home/user/.ssh/id_ed25519 (a (b)) to agent?",
+    "Add key /home/user/.ssh/id_ed25519 to agent?",
+    // git
+    "Password (user@imap.example.org): ",
+    "Password (imap.example.org): ",
+    "Username: ",
+    "Password: ",
+    "Username for 'https://github.com': ",
+    "Password for 'https://user@github.com': ",
+    "Username for 'https://github.com': \n",
+    "Username for \"https://github.com\"",
+    "Password for \"https://user@github.com\"",
+    "Password for \"a\" and \"b\"",
+    // sudo
+    "[sudo] password for user: ",
+    "[sudo] password for : ",
+    // one-time passwords with the asking user@host
+    "(user@host) Verification code: ",
+    // mercurial
+    "hguser's password: ",
+    "a's password: b's password: ",
+    // nothing known
+    "",
+    "\n",
+    "Please enter the secret",
+    "user@host's password: trailing",
+};
+
+struct Difference {
+    const char *prompt;
+    Classification expected;
+};
+
+// Prompts that are classified differently on purpose, with what the rules give for them
+const Difference differences[] = {
+    {"Verification code: ", {QString(), TypeOtp, CategoryOtp, false, false, false}},
+    {"(user) Verification code: ", {QString(), TypeOtp, CategoryOtp, false, false, false}},
+    {"One-time password (OATH) for `user': ", {QString(), TypeOtp, CategoryOtp, false, false, false}},
+    {"(admin@host) One-time password (OATH) for `user': ", {QStringLiteral("otp:admin@host"), TypeOtp, CategoryOtp, false, false, false}},
+    {"(user@host) One-time password (OATH) for `user': ", {QStringLiteral("otp:user@host"), TypeOtp, CategoryOtp, false, false, false}},
+};
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 2 && strcmp(argv[1], "--list") == 0) {
+        for (const char *prompt : samePrompts) {
+            fwrite(prompt, 1, strlen(prompt) + 1, stdout);
+        }
+        for (const Difference &difference : differences) {
+            fwrite(difference.prompt, 1, strlen(difference.prompt) + 1, stdout);
+        }
+        return 0;
+    }
+
+    QCoreApplication app(argc, argv);
+    // Prompts no rule knows must not get an identifier from the user's settings
+    QStandardPaths::setTestModeEnabled(true);
+    QTextStream out(stdout);
+    int failures = 0;
+
+    const auto check = [&](const QString &prompt, const Classification &expected, const char *what) {
+        const Classification actual = classification(prompt);
+        if (!(actual == expected)) {
+            ++failures;
+            out << "Prompt \"" << QString(prompt).replace(QLatin1Char('\n'), QLatin1String("\\n")) << "\":\n"
+                << "  " << what << ": " << describe(expected) << "\n"
+                << "  rules: " << describe(actual) << "\n";
+        }
+    };
+
+    for (const char *prompt : samePrompts) {
+        const QString text = QString::fromUtf8(prompt);
+        check(text, legacyClassification(text), "expressions");
+    }
+    for (const Difference &difference : differences) {
+        const QString text = QString::fromUtf8(difference.prompt);
+        if (legacyClassification(text) == difference.expected) {
+            ++failures;
+            out << "Prompt \"" << text << "\" is listed as a difference, but the expressions agree\n";
+        }
+        check(text, difference.expected, "expected");
+    }
+
+    // Too long to be parsed, the expressions would have taken it as a password for user@host
+    const QString longPrompt = QStringLiteral("user@") + QString(4096, QLatin1Char('h')) + QStringLiteral("'s password: ");
+    check(longPrompt, Classification(), "expected");
+
+    const int total = int(std::size(samePrompts) + std::size(differences) + 1);
+    out << (total - failures) << " of " << total << " prompts classified as expected\n";
+    return failures == 0 ? 0 : 1;
+}
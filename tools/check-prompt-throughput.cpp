@@ -0,0 +1,123 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+// Times the rules in src/prompt.cpp on prompts of the longest length they parse, 4096 characters, made of the
+// pieces the rules look for repeated over and over, and fails if any of them parses at fewer prompts per second
+// than the minimum given. A rule that searches again from every occurrence of a piece slows down with the square
+// of the length, which is what this catches. Run it with "make check-prompt-throughput".
+//
+//   prompt-throughput-check <prompts per second>
+
+#include "prompt.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+#include <QTextStream>
+
+namespace
+{
+const int promptLength = 4096;
+
+// Each piece is repeated to fill a prompt, alone and between the start and end of real prompts
+const char *const pieces[] = {
+    "@",
+    "'s password: ",
+    " (",
+    "\n",
+    "'",
+    ": ",
+    "(user@host) ",
+    "@host'",
+    " on ",
+    "://",
+    " (will confirm each use)",
+};
+
+const char *const frames[][2] = {
+    {"", ""},
+    {"", "'s password: "},
+    {"(", ") Password: "},
+    {"Enter passphrase for key '", "': "},
+    {"Enter passphrase for ", " (will confirm each use): "},
+    {"Password for '", "': "},
+    {"[sudo] password for ", ": "},
+    {"", "\n"},
+};
+
+QString hostilePrompt(const char *piece, const char *const frame[2])
+{
+    const QString start = QString::fromUtf8(frame[0]);
+    const QString end = QString::fromUtf8(frame[1]);
+    const QString repeated = QString::fromUtf8(piece);
+    QString middle;
+    while (middle.size() < promptLength - start.size() - end.size()) {
+        middle += repeated;
+    }
+    middle.truncate(promptLength - start.size() - end.size());
+    return start + middle + end;
+}
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    // Prompts no rule knows must not get an identifier from the user's settings
+    QStandardPaths::setTestModeEnabled(true);
+    // Prompts no rule knows are logged, which is not what is timed here
+    QLoggingCategory::setFilterRules(QStringLiteral("*.warning=false"));
+    QTextStream out(stdout);
+
+    bool valid = false;
+    const double minimum = app.arguments().value(1).toDouble(&valid);
+    if (!valid || minimum <= 0) {
+        out << "Usage: " << app.arguments().constFirst() << " <prompts per second>\n";
+        return 2;
+    }
+
+    QStringList prompts;
+    for (const char *piece : pieces) {
+        for (const auto &frame : frames) {
+            prompts << hostilePrompt(piece, frame);
+        }
+    }
+    // All of them at once
+    QString mixed;
+    while (mixed.size() < promptLength) {
+        for (const char *piece : pieces) {
+            mixed += QString::fromUtf8(piece);
+        }
+    }
+    mixed.truncate(promptLength);
+    prompts << mixed;
+
+    int failures = 0;
+    double slowest = -1;
+    for (const QString &prompt : std::as_const(prompts)) {
+        // Parse for at least 50 ms, so the timer's resolution doesn't matter
+        QElapsedTimer timer;
+        int runs = 0;
+        timer.start();
+        do {
+            const ParsedPrompt parsed(prompt);
+            Q_UNUSED(parsed);
+            ++runs;
+        } while (timer.nsecsElapsed() < 50 * 1000 * 1000);
+        const double rate = runs / (timer.nsecsElapsed() / 1e9);
+        if (slowest < 0 || rate < slowest) {
+            slowest = rate;
+        }
+        if (rate < minimum) {
+            ++failures;
+            out << "Prompt \"" << QString(prompt.left(60)).replace(QLatin1Char('\n'), QLatin1String("\\n")) << "...\": " << qRound64(rate)
+                << " prompts per second\n";
+        }
+    }
+
+    out << (prompts.size() - failures) << " of " << prompts.size() << " prompts of " << promptLength << " characters parsed at " << qRound64(minimum)
+        << " or more prompts per second, the slowest at " << qRound64(slowest) << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 ksshaskpass authors
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+// Feeds arbitrary UTF-16 through the rules in src/prompt.cpp. Built with -DENABLE_FUZZING=ON and clang, run it
+// with "make fuzz-prompt-rules", see INSTALL.
+//
+// Besides what the sanitizers catch, a prompt must be classified the same with a final newline added, as scripts
+// may well add one.
+
+#include "prompt.h"
+
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+static bool sameClassification(const ParsedPrompt &a, const ParsedPrompt &b)
+{
+    return a.identifier == b.identifier && a.type == b.type && a.category == b.category && a.passwordChange == b.passwordChange
+        && a.ignoreWallet == b.ignoreWallet && a.retry == b.retry && a.sessionOnly == b.sessionOnly && a.guessedIdentifier == b.guessedIdentifier;
+}
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    static std::unique_ptr<QCoreApplication> app = std::make_unique<QCoreApplication>(*argc, *argv);
+    // Prompts no rule knows must not get an identifier from the user's settings
+    QStandardPaths::setTestModeEnabled(true);
+    // Prompts no rule knows are logged, which would only slow the fuzzer down
+    QLoggingCategory::setFilterRules(QStringLiteral("*.warning=false"));
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    QString text(int(size / sizeof(char16_t)), Qt::Uninitialized);
+    memcpy(text.data(), data, text.size() * sizeof(char16_t));
+
+    const ParsedPrompt parsed(text);
+    if (text.size() < 4096 && !text.endsWith(QLatin1Char('\n')) && !sameClassification(parsed, ParsedPrompt(text + QLatin1Char('\n')))) {
+        abort();
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+#!/bin/sh
+# SPDX-FileCopyrightText: 2026 ksshaskpass authors
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# Measures the peak resident set size and the private dirty memory of ksshaskpass on each of its paths: answering
+# from the wallet, asking with a dialog and asking for a confirmation. Fails if the wallet hit goes over the budget.
+# The time a wallet hit takes is reported too, to compare builds with, e.g. before and after a profile-guided one.
+#
+#   measure-memory.sh <ksshaskpass> <peak RSS budget in KiB> <private dirty budget in KiB>
+#
+# The wallet is replaced by a secret helper that knows one password, so nothing stored is touched. The dialogs
+# need a display, without one only the wallet hit is measured. They are measured once they had time to show up
+# and are closed right after.
+
+set -eu
+
+program=$1
+rss_budget=$2
+dirty_budget=$3
+dialog_wait=${DIALOG_WAIT:-3}
+hit_runs=${HIT_RUNS:-20}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Default settings, whatever the user configured
+mkdir "$work/config"
+export XDG_CONFIG_HOME="$work/config"
+
+cat >"$work/helper" <<'HELPER'
+#!/bin/sh
+case "$1 $3" in
+"get user@host.example") printf 'secret' ;;
+"list "*) ;;
+*) exit 1 ;;
+esac
+HELPER
+chmod +x "$work/helper"
+export KSSHASKPASS_SECRET_HELPER="$work/helper"
+
+# Prints "<peak RSS> <private dirty>" in KiB of a process that is still running
+sample() {
+    rss=$(sed -n 's/^VmHWM: *\([0-9]*\) kB/\1/p' "/proc/$1/status")
+    dirty=$(sed -n 's/^Private_Dirty: *\([0-9]*\) kB/\1/p' "/proc/$1/smaps_rollup")
+    echo "$rss $dirty"
+}
+
+# The wallet hit exits by itself and reports its memory use on the way out
+report=$(QT_LOGGING_RULES="ksshaskpass.debug=true" "$program" "user@host.example's password: " 2>&1 >/dev/null)
+hit_rss=$(echo "$report" | sed -n 's/.*Peak resident set size: \([0-9]*\) KiB.*/\1/p')
+hit_dirty=$(echo "$report" | sed -n 's/.*Private_Dirty: *\([0-9]*\) kB.*/\1/p')
+if [ -z "$hit_rss" ] || [ -z "$hit_dirty" ]; then
+    echo "The wallet hit did not report its memory use:" >&2
+    echo "$report" >&2
+    exit 1
+fi
+
+# Wall-clock time, the mean of a few runs in microseconds
+start=$(date +%s%N)
+i=0
+while [ "$i" -lt "$hit_runs" ]; do
+    "$program" "user@host.example's password: " >/dev/null 2>&1
+    i=$((i + 1))
+done
+hit_time=$((($(date +%s%N) - start) / hit_runs / 1000))
+
+printf '%-12s %12s %18s\n' "path" "peak RSS KiB" "private dirty KiB"
+printf '%-12s %12s %18s\n' "wallet hit" "$hit_rss" "$hit_dirty"
+
+if [ -n "${WAYLAND_DISPLAY:-}${DISPLAY:-}" ]; then
+    for path in dialog confirm; do
+        case $path in
+        dialog) prompt="other@host.example's password: " ;;
+        confirm) prompt="Allow shared connection to host.example? " ;;
+        esac
+        "$program" "$prompt" >/dev/null 2>&1 &
+        pid=$!
+        sleep "$dialog_wait"
+        if kill -0 "$pid" 2>/dev/null; then
+            set -- $(sample "$pid")
+            kill "$pid"
+            printf '%-12s %12s %18s\n' "$path" "$1" "$2"
+        else
+            echo "The $path exited before it could be measured"
+        fi
+        wait "$pid" 2>/dev/null || true
+    done
+else
+    echo "No display, not measuring the dialogs"
+fi
+
+printf 'A wallet hit takes %d.%03d ms, the mean of %d runs\n' $((hit_time / 1000)) $((hit_time % 1000)) "$hit_runs"
+
+status=0
+if [ "$hit_rss" -gt "$rss_budget" ]; then
+    echo "The wallet hit peaked at $hit_rss KiB, the budget is $rss_budget KiB" >&2
+    status=1
+fi
+if [ "$hit_dirty" -gt "$dirty_budget" ]; then
+    echo "The wallet hit dirtied $hit_dirty KiB, the budget is $dirty_budget KiB" >&2
+    status=1
+fi
+exit $status
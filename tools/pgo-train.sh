@@ -0,0 +1,64 @@
+#!/bin/sh
+# SPDX-FileCopyrightText: 2026 ksshaskpass authors
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# Runs the instrumented ksshaskpass of a PGO_MODE=GENERATE build through its usual paths, without a wallet or a
+# display: every sample prompt of check-prompt-rules is answered once from a stand-in wallet (the hit) and once
+# with a dialog (the miss), which is canceled right after it shows up.
+#
+#   pgo-train.sh <ksshaskpass> <prompt-rules-check> <profile directory>
+#
+# The stand-in wallet is a secret helper that knows a password for every key on the first run and none on the
+# second. Dialogs use Qt's offscreen platform. The profile goes to the directory the build was configured with,
+# clang's raw profiles are merged into default.profdata there if llvm-profdata is found.
+
+set -eu
+
+program=$1
+checker=$2
+profile_dir=$3
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Default settings, whatever the user configured, and no decisions shared through the user's keyring
+mkdir "$work/config"
+export XDG_CONFIG_HOME="$work/config"
+printf '[Dialogs]\nRepeatWindow=0\n' >"$work/config/ksshaskpassrc"
+
+cat >"$work/hit" <<'HELPER'
+#!/bin/sh
+case "$1 $3" in
+"get ."*) exit 1 ;;
+"get "*) printf 'secret' ;;
+"list "*) ;;
+*) exit 1 ;;
+esac
+HELPER
+cat >"$work/miss" <<'HELPER'
+#!/bin/sh
+exit 1
+HELPER
+cat >"$work/run" <<RUN
+#!/bin/sh
+for helper in hit miss; do
+    KSSHASKPASS_SECRET_HELPER="$work/\$helper" "$program" "\$1" </dev/null >/dev/null 2>&1 || true
+done
+RUN
+chmod +x "$work/hit" "$work/miss" "$work/run"
+
+export KSSHASKPASS_PGO_TRAINING=1
+export QT_QPA_PLATFORM=offscreen
+
+count=$("$checker" --list | tr -cd '\0' | wc -c)
+echo "Training with $count prompts"
+"$checker" --list | xargs -0 -n 1 "$work/run"
+
+if ls "$profile_dir"/*.profraw >/dev/null 2>&1; then
+    if command -v llvm-profdata >/dev/null; then
+        llvm-profdata merge -o "$profile_dir/default.profdata" "$profile_dir"/*.profraw
+        echo "Merged the profile into $profile_dir/default.profdata"
+    else
+        echo "llvm-profdata not found, merge $profile_dir/*.profraw into default.profdata by hand" >&2
+    fi
+fi